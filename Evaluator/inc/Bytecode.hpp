@@ -0,0 +1,52 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "../../Node/inc/Node.hpp"
+
+/*
+ * An expression compiled for a stack machine. Constants are folded and pooled, variables are read from slots the
+ * caller fills in getSlots() order, and calls to user functions are inlined with their arguments kept in locals,
+ * so one program can be run again and again with new variable values.
+ */
+class Bytecode {
+public:
+    enum class Opcode : uint8_t {
+        Constant, Load, LoadLocal, StoreLocal,
+        Add, Sub, Mul, Div, Pow, Neg, Fact, Sin, Cos, Tan, Log, Ln, Sqrt, Abs, Atan2
+    };
+
+    struct Instruction {
+        Opcode opcode;
+        uint32_t operand; /* Constant, slot or local index */
+    };
+
+    /* Returns nullopt for trees the tree walking Evaluator would reject or that inline to more than maxInstructions */
+    static std::optional<Bytecode> compile(const Node *root, const SymbolMap<ConstNodePtr> &functions);
+
+    /* Variables the program reads, slot i holds the value of getSlots()[i] */
+    [[nodiscard]] const std::vector<SymbolId> &getSlots() const { return slots; }
+    /* Number of doubles run needs as scratch space, the locals come first */
+    [[nodiscard]] size_t getScratchSize() const { return localCount + maxStack; }
+    [[nodiscard]] const std::vector<Instruction> &getCode() const { return code; }
+    [[nodiscard]] const std::vector<double> &getConstants() const { return constants; }
+    [[nodiscard]] uint32_t getLocalCount() const { return localCount; }
+
+    /* Returns false where the Evaluator would report an error, which only division by zero can cause */
+    bool run(const double *slotValues, double *scratch, double &result) const;
+
+private:
+    static constexpr size_t maxInstructions = 1 << 16;
+
+    std::vector<Instruction> code;
+    std::vector<double> constants;
+    std::vector<SymbolId> slots;
+    uint32_t localCount = 0;
+    uint32_t maxStack = 0;
+
+    friend class BytecodeCompiler;
+};
@@ -6,27 +6,89 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "../../Node/inc/Node.hpp"
+#include "../../Node/inc/FlatTree.hpp"
+#include "Bytecode.hpp"
+#include "Jit.hpp"
 
 class Evaluator {
 public:
-    double evaluate(const std::shared_ptr<Node>& node);
+    double evaluate(const NodePtr& node);
+    /* Evaluates in one forward sweep, calls to user functions still evaluate their Node body */
+    double evaluate(const FlatTree& tree);
     void clearVariable(const std::string& name);
     [[nodiscard]] std::string getError() const;
 
+    /* A compiled result that differs from the tree walk, found with verification on */
+    struct CompiledMismatch {
+        NodePtr statement;
+        const char* backend; /* "bytecode" or "native" */
+        double expected;     /* Result of the tree walk */
+        double actual;
+    };
+
+    /* Compiles every statement on its first evaluation and checks each compiled result against the tree walk,
+       whose result is the one returned */
+    void setVerifyCompiled(bool verify) { verifyCompiled = verify; }
+    [[nodiscard]] const std::vector<CompiledMismatch>& getCompiledMismatches() const { return compiledMismatches; }
+    /* Number of evaluations answered by bytecode or machine code instead of the tree walk */
+    [[nodiscard]] uint64_t getCompiledEvaluations() const { return compiledEvaluations; }
+
 private:
     struct CallFrame {
         std::vector<double> evaluatedArguments;
     };
 
-    double evaluateNode(const std::shared_ptr<Node>& node);
+    double evaluateNode(const NodePtr& node);
+    double evaluateFlat(const FlatTree& tree);
+    /* Fills sweepValues in post-order; malformed is set when a node lacks an operand */
+    void sweep(const FlatTree& tree, bool& malformed);
+    /* Runs the statement as bytecode once it is evaluated a second time, false leaves it to the tree walk */
+    bool evaluateCompiled(const NodePtr& node, double& result);
+    struct CompiledStatement;
+    /* Returns nullptr while the statement is left to the tree walk */
+    CompiledStatement* findCompiled(const NodePtr& node);
+    /* Fills slotValues, false if a variable the program reads is undefined */
+    bool loadSlots(const Bytecode& program);
+    void verify(const NodePtr& node, double expected, const std::vector<std::pair<const char*, double>>& results);
+
+    SymbolMap<double> variables;
 
-    std::unordered_map<std::string, double> variables;
+    SymbolMap<ConstNodePtr> functions;
+    uint64_t functionsVersion = 0; /* Bumped whenever a function is defined, programs inline the definitions */
 
-    std::unordered_map<std::string, std::weak_ptr<const Node>> functions;
+    /* Statements are told apart by structure, so the equal trees a plot batch parses for every point share one program */
+    struct StatementKey {
+        ConstNodePtr statement;
+        bool operator==(const StatementKey& other) const { return Node::equal(statement.get(), other.statement.get()); }
+    };
+    struct StatementKeyHash {
+        size_t operator()(const StatementKey& key) const { return key.statement->getHash(); }
+    };
+
+    /* Programs of statements evaluated more than once, such as the ones a plot evaluates for every point. A failed
+       compile is kept as nullopt. A program that has run jitThreshold times is translated to machine code, shared
+       so that copies of the Evaluator can run it. */
+    struct CompiledStatement {
+        uint64_t functionsVersion;
+        std::optional<Bytecode> program;
+        uint32_t runs = 0;
+        std::shared_ptr<const JitFunction> native;
+    };
+    static constexpr size_t maxCompiledStatements = 256;
+    static constexpr uint32_t jitThreshold = 256;
+    std::unordered_map<StatementKey, CompiledStatement, StatementKeyHash> compiled;
+    std::unordered_set<StatementKey, StatementKeyHash> evaluatedOnce;
+    uint64_t compiledEvaluations = 0;
+    std::vector<double> slotValues;
+    std::vector<double> scratch;
+    bool verifyCompiled = false;
+    std::vector<CompiledMismatch> compiledMismatches;
 
     std::vector<CallFrame> callStack;
+    std::vector<double> sweepValues; /* Value of every node of the FlatTree being evaluated, reused across calls */
     std::string error;
 };
 
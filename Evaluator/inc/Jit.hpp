@@ -0,0 +1,38 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#pragma once
+#include <cstddef>
+#include <optional>
+#include "Bytecode.hpp"
+
+/*
+ * Bytecode translated to x86-64 machine code with scalar SSE2 in executable pages of its own. The stack of the
+ * program lives at fixed offsets in the native frame, so every instruction becomes a few loads, one operation and a
+ * store; sin, ln, atan2 and the like are calls into libm. On other targets compile always returns nullopt.
+ */
+class JitFunction {
+public:
+    /* Takes the slot values in Bytecode::getSlots() order */
+    using Entry = double (*)(const double *slotValues);
+
+    /* Returns nullopt if the target is not x86-64 or executable memory cannot be mapped */
+    static std::optional<JitFunction> compile(const Bytecode &program);
+
+    JitFunction(JitFunction &&other) noexcept;
+    JitFunction &operator=(JitFunction &&other) noexcept;
+    JitFunction(const JitFunction &) = delete;
+    JitFunction &operator=(const JitFunction &) = delete;
+    ~JitFunction();
+
+    /* NaN where Bytecode::run fails, callers that see NaN run the bytecode to tell a division by zero apart */
+    double operator()(const double *slotValues) const { return entry(slotValues); }
+
+private:
+    JitFunction(void *memory, size_t size);
+
+    void *memory;
+    size_t size;
+    Entry entry;
+};
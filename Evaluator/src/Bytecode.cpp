@@ -0,0 +1,251 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include "../inc/Bytecode.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <string>
+#include "../../Util/inc/ASTUtil.hpp"
+
+using Opcode = Bytecode::Opcode;
+
+/* Used to fold constants, matches what run computes for the same operands */
+static double apply(Opcode opcode, double a, double b) {
+    switch (opcode) {
+        case Opcode::Add: return a + b;
+        case Opcode::Sub: return a - b;
+        case Opcode::Mul: return a * b;
+        case Opcode::Div: return a / b;
+        case Opcode::Pow: return std::pow(a, b);
+        case Opcode::Neg: return -a;
+        case Opcode::Fact: return factorial(a);
+        case Opcode::Sin: return std::sin(a);
+        case Opcode::Cos: return std::cos(a);
+        case Opcode::Tan: return std::tan(a);
+        case Opcode::Log: return std::log10(a);
+        case Opcode::Ln: return std::log(a);
+        case Opcode::Sqrt: return std::sqrt(a);
+        case Opcode::Abs: return std::abs(a);
+        case Opcode::Atan2: return std::atan2(a, b);
+        default: return NAN;
+    }
+}
+
+static Opcode getOpcode(Node::Op op) {
+    switch (op) {
+        case Node::Op::Add: return Opcode::Add;
+        case Node::Op::Sub: return Opcode::Sub;
+        case Node::Op::Mul: return Opcode::Mul;
+        case Node::Op::Div: return Opcode::Div;
+        case Node::Op::Pow: return Opcode::Pow;
+        case Node::Op::Neg: return Opcode::Neg;
+        case Node::Op::Fact: return Opcode::Fact;
+        case Node::Op::Sin: return Opcode::Sin;
+        case Node::Op::Cos: return Opcode::Cos;
+        case Node::Op::Tan: return Opcode::Tan;
+        case Node::Op::Log: return Opcode::Log;
+        case Node::Op::Ln: return Opcode::Ln;
+        case Node::Op::Sqrt: return Opcode::Sqrt;
+        case Node::Op::Abs: return Opcode::Abs;
+        case Node::Op::Atan2: return Opcode::Atan2;
+        default: return Opcode::Constant;
+    }
+}
+
+/* Walks the tree once, refusing every node the tree walking Evaluator would raise an error for */
+class BytecodeCompiler {
+public:
+    BytecodeCompiler(Bytecode &program, const SymbolMap<ConstNodePtr> &functions) : program(program), functions(functions) {}
+
+    bool compileNode(const Node *node);
+
+private:
+    struct Frame {
+        uint32_t base;     /* First local holding an argument */
+        uint32_t argCount;
+    };
+
+    Bytecode &program;
+    const SymbolMap<ConstNodePtr> &functions;
+    SymbolMap<uint32_t> slotIndices;
+    std::vector<Frame> frames;       /* Calls being inlined, innermost last */
+    std::vector<SymbolId> inlining;  /* Functions of those calls, a recursive call is refused */
+    uint32_t depth = 0;
+    uint32_t localTop = 0;
+
+    bool emit(Opcode opcode, uint32_t operand, int stackEffect);
+    bool emitConstant(double value);
+    bool emitOperation(Opcode opcode, size_t arity);
+    bool compileOperands(const Node *node, size_t arity);
+    bool compileCall(const Node *node);
+    bool compileParameter(const Node *node);
+};
+
+bool BytecodeCompiler::emit(Opcode opcode, uint32_t operand, int stackEffect) {
+    if (program.code.size() >= Bytecode::maxInstructions) return false;
+    program.code.push_back({opcode, operand});
+    depth += stackEffect;
+    program.maxStack = std::max(program.maxStack, depth);
+    return true;
+}
+
+bool BytecodeCompiler::emitConstant(double value) {
+    program.constants.push_back(value);
+    return emit(Opcode::Constant, static_cast<uint32_t>(program.constants.size() - 1), 1);
+}
+
+/*
+ * The value of an expression is pushed by its last instruction, and an expression longer than one instruction
+ * never ends in two constants, so constants at the end of the code are exactly the operands that are constant.
+ */
+bool BytecodeCompiler::emitOperation(Opcode opcode, size_t arity) {
+    auto &code = program.code;
+    bool constant = code.size() >= arity;
+    for (size_t i = 1; constant && i <= arity; ++i) constant = code[code.size() - i].opcode == Opcode::Constant;
+    if (!constant) return emit(opcode, 0, 1 - static_cast<int>(arity));
+
+    const double a = program.constants[code[code.size() - arity].operand];
+    const double b = arity == 2 ? program.constants[code.back().operand] : 0.0;
+    if (opcode == Opcode::Div && b == 0) return emit(opcode, 0, -1); /* Left to fail when run */
+    for (size_t i = 0; i < arity; ++i) {
+        if (code.back().operand + 1 == program.constants.size()) program.constants.pop_back();
+        code.pop_back();
+    }
+    depth -= static_cast<uint32_t>(arity);
+    return emitConstant(apply(opcode, a, b));
+}
+
+bool BytecodeCompiler::compileOperands(const Node *node, size_t arity) { // NOLINT(*-no-recursion)
+    if (node->children.size() < arity) return false;
+    for (size_t i = 0; i < arity; ++i)
+        if (!compileNode(node->children[i].get())) return false;
+    return true;
+}
+
+bool BytecodeCompiler::compileNode(const Node *node) { // NOLINT(*-no-recursion)
+    if (!node) return false;
+
+    switch (node->type) {
+        case Node::Type::Number:
+            return emitConstant(node->number);
+
+        case Node::Type::Variable: {
+            if (node->op == Node::Op::Pi) return emitConstant(M_PI);
+            if (node->op == Node::Op::E) return emitConstant(M_E);
+            if (!slotIndices.contains(node->symbol)) {
+                slotIndices.insert(node->symbol, static_cast<uint32_t>(program.slots.size()));
+                program.slots.push_back(node->symbol);
+            }
+            return emit(Opcode::Load, *slotIndices.find(node->symbol), 1);
+        }
+
+        case Node::Type::Operand:
+            switch (node->op) {
+                case Node::Op::Add:
+                    if (node->children.size() == 1) return compileNode(node->children[0].get());
+                    [[fallthrough]];
+                case Node::Op::Sub: case Node::Op::Mul: case Node::Op::Div: case Node::Op::Pow:
+                    return compileOperands(node, 2) && emitOperation(getOpcode(node->op), 2);
+                case Node::Op::Neg: case Node::Op::Fact:
+                    return compileOperands(node, 1) && emitOperation(getOpcode(node->op), 1);
+                default:
+                    return false;
+            }
+
+        case Node::Type::Function:
+            switch (node->op) {
+                case Node::Op::None:
+                    return compileCall(node);
+                case Node::Op::Atan2:
+                    return compileOperands(node, 2) && emitOperation(Opcode::Atan2, 2);
+                default:
+                    return compileOperands(node, 1) && emitOperation(getOpcode(node->op), 1);
+            }
+
+        case Node::Type::Parameter:
+            return compileParameter(node);
+
+        default:
+            return false;
+    }
+}
+
+bool BytecodeCompiler::compileCall(const Node *node) { // NOLINT(*-no-recursion)
+    const ConstNodePtr *definition = functions.find(node->symbol);
+    if (!definition || (*definition)->children.empty()) return false;
+    if (std::find(inlining.begin(), inlining.end(), node->symbol) != inlining.end()) return false;
+
+    /* Arguments are evaluated in order under the caller's frame, then moved into locals the body reads */
+    const auto argCount = static_cast<uint32_t>(node->children.size());
+    if (!compileOperands(node, argCount)) return false;
+    const uint32_t base = localTop;
+    localTop += argCount;
+    program.localCount = std::max(program.localCount, localTop);
+    for (uint32_t i = argCount; i-- > 0;)
+        if (!emit(Opcode::StoreLocal, base + i, -1)) return false;
+
+    frames.push_back({base, argCount});
+    inlining.push_back(node->symbol);
+    const bool compiled = compileNode((*definition)->children[0].get());
+    inlining.pop_back();
+    frames.pop_back();
+    localTop = base;
+    return compiled;
+}
+
+bool BytecodeCompiler::compileParameter(const Node *node) {
+    if (frames.empty()) return false;
+    /* Parameter names are "<index>-<name>" */
+    const std::string &name = node->name();
+    uint32_t index = 0;
+    auto [end, error] = std::from_chars(name.data(), name.data() + name.size(), index);
+    if (error != std::errc() || end == name.data() + name.size() || *end != '-') return false;
+    if (index >= frames.back().argCount) return false;
+    return emit(Opcode::LoadLocal, frames.back().base + index, 1);
+}
+
+std::optional<Bytecode> Bytecode::compile(const Node *root, const SymbolMap<ConstNodePtr> &functions) {
+    Bytecode program;
+    BytecodeCompiler compiler(program, functions);
+    if (!compiler.compileNode(root)) return std::nullopt;
+    program.code.shrink_to_fit();
+    program.constants.shrink_to_fit();
+    return program;
+}
+
+bool Bytecode::run(const double *slotValues, double *scratch, double &result) const {
+    double *locals = scratch;
+    double *top = scratch + localCount; /* One past the top of the stack */
+    for (const Instruction &instruction: code) {
+        switch (instruction.opcode) {
+            case Opcode::Constant: *top++ = constants[instruction.operand]; break;
+            case Opcode::Load: *top++ = slotValues[instruction.operand]; break;
+            case Opcode::LoadLocal: *top++ = locals[instruction.operand]; break;
+            case Opcode::StoreLocal: locals[instruction.operand] = *--top; break;
+            case Opcode::Add: --top; top[-1] = top[-1] + *top; break;
+            case Opcode::Sub: --top; top[-1] = top[-1] - *top; break;
+            case Opcode::Mul: --top; top[-1] = top[-1] * *top; break;
+            case Opcode::Div:
+                if (top[-1] == 0) return false;
+                --top;
+                top[-1] = top[-1] / *top;
+                break;
+            case Opcode::Pow: --top; top[-1] = std::pow(top[-1], *top); break;
+            case Opcode::Atan2: --top; top[-1] = std::atan2(top[-1], *top); break;
+            case Opcode::Neg: top[-1] = -top[-1]; break;
+            case Opcode::Fact: top[-1] = factorial(top[-1]); break;
+            case Opcode::Sin: top[-1] = std::sin(top[-1]); break;
+            case Opcode::Cos: top[-1] = std::cos(top[-1]); break;
+            case Opcode::Tan: top[-1] = std::tan(top[-1]); break;
+            case Opcode::Log: top[-1] = std::log10(top[-1]); break;
+            case Opcode::Ln: top[-1] = std::log(top[-1]); break;
+            case Opcode::Sqrt: top[-1] = std::sqrt(top[-1]); break;
+            case Opcode::Abs: top[-1] = std::abs(top[-1]); break;
+        }
+    }
+    result = top[-1];
+    return true;
+}
@@ -3,23 +3,51 @@
 //
 #include "../inc/Evaluator.hpp"
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 #include "../../Util/inc/ASTUtil.hpp"
 
-template <typename K, typename V>
-static bool contains(const std::unordered_map<K, V>& map, const K& key) {
-    return map.find(key) != map.end();
-}
-
-double Evaluator::evaluate(const std::shared_ptr<Node>& node) {
+double Evaluator::evaluate(const NodePtr& node) {
     error.clear();
     callStack.clear();
+    double result;
+    if (node && !verifyCompiled && evaluateCompiled(node, result)) return result;
+
+    // Compiled results are taken before the tree walk, which may assign a variable they read
+    std::vector<std::pair<const char*, double>> compiledResults;
+    if (node && verifyCompiled) {
+        if (CompiledStatement* statement = findCompiled(node); statement && loadSlots(*statement->program)) {
+            scratch.resize(statement->program->getScratchSize());
+            if (statement->program->run(slotValues.data(), scratch.data(), result)) {
+                compiledResults.emplace_back("bytecode", result);
+                if (statement->native) compiledResults.emplace_back("native", (*statement->native)(slotValues.data()));
+            }
+        }
+    }
     try {
         if (!node) {
             throw std::runtime_error("Cannot evaluate a null AST node.");
         }
-        return evaluateNode(node);
+        result = evaluateNode(node);
+    } catch (const std::runtime_error& e) {
+        error = e.what();
+        // The compiled forms have to fail wherever the tree walk does
+        for (const auto& [backend, actual] : compiledResults) compiledMismatches.push_back({node, backend, NAN, actual});
+        return NAN;
+    }
+    if (verifyCompiled) verify(node, result, compiledResults);
+    return result;
+}
+
+double Evaluator::evaluate(const FlatTree& tree) {
+    error.clear();
+    callStack.clear();
+    try {
+        if (tree.empty()) {
+            throw std::runtime_error("Cannot evaluate an empty AST.");
+        }
+        return evaluateFlat(tree);
     } catch (const std::runtime_error& e) {
         error = e.what();
         return NAN;
@@ -30,100 +58,97 @@ std::string Evaluator::getError() const {
     return error;
 }
 
-double Evaluator::evaluateNode(const std::shared_ptr<Node>& node) { // NOLINT(*-no-recursion)
+double Evaluator::evaluateNode(const NodePtr& node) { // NOLINT(*-no-recursion)
     if (!node) {
         throw std::runtime_error("Encountered a null node during evaluation.");
     }
 
     switch (node->type) {
         case Node::Type::Number:
-            return std::stod(node->value);
+            return node->number;
 
         case Node::Type::Variable: {
-            if (node->value == "pi") return M_PI;
-            if (node->value == "e") return M_E;
-            if (!contains(variables, node->value)) {
-                throw std::runtime_error("Undefined variable: '" + node->value + "'");
+            if (node->op == Node::Op::Pi) return M_PI;
+            if (node->op == Node::Op::E) return M_E;
+            const double* value = variables.find(node->symbol);
+            if (!value) {
+                throw std::runtime_error("Undefined variable: '" + node->name() + "'");
             }
-            return variables.at(node->value);
+            return *value;
         }
 
         case Node::Type::Assignment: {
             double value = evaluateNode(node->children[0]);
-            variables[node->value] = value;
+            variables[node->symbol] = value;
             return value;
         }
 
         case Node::Type::FunctionAssignment:
-            functions[node->value] = node;
+            functions[node->symbol] = node;
+            functionsVersion++;
             return NAN;
 
         case Node::Type::Operand: {
-            if (node->value == "+") {
-                if (node->children.size() == 1) return evaluateNode(node->children[0]);
-                return evaluateNode(node->children[0]) + evaluateNode(node->children[1]);
-            }
-            if (node->value == "-") {
-                if (node->children.size() == 1) return -evaluateNode(node->children[0]);
-                return evaluateNode(node->children[0]) - evaluateNode(node->children[1]);
-            }
-            if (node->value == "*") return evaluateNode(node->children[0]) * evaluateNode(node->children[1]);
-            if (node->value == "/") {
-                double divisor = evaluateNode(node->children[1]);
-                if (divisor == 0) throw std::runtime_error("Division by zero.");
-                return evaluateNode(node->children[0]) / divisor;
+            switch (node->op) {
+                case Node::Op::Add:
+                    if (node->children.size() == 1) return evaluateNode(node->children[0]);
+                    return evaluateNode(node->children[0]) + evaluateNode(node->children[1]);
+                case Node::Op::Sub: return evaluateNode(node->children[0]) - evaluateNode(node->children[1]);
+                case Node::Op::Neg: return -evaluateNode(node->children[0]);
+                case Node::Op::Mul: return evaluateNode(node->children[0]) * evaluateNode(node->children[1]);
+                case Node::Op::Div: {
+                    double divisor = evaluateNode(node->children[1]);
+                    if (divisor == 0) throw std::runtime_error("Division by zero.");
+                    return evaluateNode(node->children[0]) / divisor;
+                }
+                case Node::Op::Pow: return std::pow(evaluateNode(node->children[0]), evaluateNode(node->children[1]));
+                case Node::Op::Fact: return factorial(evaluateNode(node->children[0]));
+                default: throw std::runtime_error("Unknown operand: " + node->name());
             }
-            if (node->value == "^") return std::pow(evaluateNode(node->children[0]), evaluateNode(node->children[1]));
-            if (node->value == "!") return factorial(evaluateNode(node->children[0]));
-            throw std::runtime_error("Unknown operand: " + node->value);
         }
 
         case Node::Type::Function: {
-            if (node->value == "sin") return std::sin(evaluateNode(node->children[0]));
-            if (node->value == "cos") return std::cos(evaluateNode(node->children[0]));
-            if (node->value == "tan") return std::tan(evaluateNode(node->children[0]));
-            if (node->value == "sqrt") return std::sqrt(evaluateNode(node->children[0]));
-            if (node->value == "log") return std::log10(evaluateNode(node->children[0]));
-            if (node->value == "ln") return std::log(evaluateNode(node->children[0]));
-            if (node->value == "abs") return std::abs(evaluateNode(node->children[0]));
-            if (node->value == "atan2") {
-                if (node->children.size() < 2) throw std::runtime_error("atan2 requires two arguments.");
-                return std::atan2(evaluateNode(node->children[0]), evaluateNode(node->children[1]));
+            switch (node->op) {
+                case Node::Op::Sin: return std::sin(evaluateNode(node->children[0]));
+                case Node::Op::Cos: return std::cos(evaluateNode(node->children[0]));
+                case Node::Op::Tan: return std::tan(evaluateNode(node->children[0]));
+                case Node::Op::Sqrt: return std::sqrt(evaluateNode(node->children[0]));
+                case Node::Op::Log: return std::log10(evaluateNode(node->children[0]));
+                case Node::Op::Ln: return std::log(evaluateNode(node->children[0]));
+                case Node::Op::Abs: return std::abs(evaluateNode(node->children[0]));
+                case Node::Op::Atan2:
+                    if (node->children.size() < 2) throw std::runtime_error("atan2 requires two arguments.");
+                    return std::atan2(evaluateNode(node->children[0]), evaluateNode(node->children[1]));
+                default: break;
             }
 
-            auto it = functions.find(node->value);
-            if (it != functions.end()) {
-                if (auto defNode = it->second.lock()) {
-                    std::vector<double> evaluatedArgs;
-                    for (const auto& arg_node : node->children) {
-                        evaluatedArgs.push_back(evaluateNode(arg_node));
-                    }
-
-                    callStack.push_back({evaluatedArgs});
+            if (const ConstNodePtr* definition = functions.find(node->symbol)) {
+                const Node* defNode = definition->get();
+                std::vector<double> evaluatedArgs;
+                for (const auto& arg_node : node->children) {
+                    evaluatedArgs.push_back(evaluateNode(arg_node));
+                }
 
-                    double result = evaluateNode(defNode->children[0]);
+                callStack.push_back({evaluatedArgs});
 
-                    callStack.pop_back();
-                    return result;
+                double result = evaluateNode(defNode->children[0]);
 
-                } else {
-                    functions.erase(it);
-                    throw std::runtime_error("Attempted to call a function that no longer exists.");
-                }
+                callStack.pop_back();
+                return result;
             }
 
-            throw std::runtime_error("Unknown function: '" + node->value + "'");
+            throw std::runtime_error("Unknown function: '" + node->name() + "'");
         }
 
         case Node::Type::Parameter: {
             if (callStack.empty()) {
                 throw std::runtime_error("Found a parameter node outside of a function call context.");
             }
-            size_t separator_pos = node->value.find('-');
+            size_t separator_pos = node->name().find('-');
             if (separator_pos == std::string::npos) {
-                throw std::runtime_error("Invalid parameter format: " + node->value);
+                throw std::runtime_error("Invalid parameter format: " + node->name());
             }
-            int index = std::stoi(node->value.substr(0, separator_pos));
+            const size_t index = std::stoul(node->name().substr(0, separator_pos));
 
             const auto& frame = callStack.back();
             if (index >= frame.evaluatedArguments.size()) {
@@ -137,9 +162,191 @@ double Evaluator::evaluateNode(const std::shared_ptr<Node>& node) { // NOLINT(*-
     }
 }
 
-void Evaluator::clearVariable(const std::string& name) {
-    auto it = variables.find(name);
-    if (it != variables.end()) {
-        variables.erase(it);
+double Evaluator::evaluateFlat(const FlatTree& tree) {
+    const uint32_t root = tree.root().index;
+    if (tree[root].type == Node::Type::FunctionAssignment) {
+        // Calls evaluate the body as a Node tree
+        functions[tree[root].symbol] = tree.toNode();
+        functionsVersion++;
+        return NAN;
+    }
+
+    sweepValues.resize(tree.size());
+    bool malformed = false;
+    try {
+        sweep(tree, malformed);
+    } catch (const std::runtime_error&) {
+        // The sweep meets errors in post-order. The tree walk checks a divisor before the dividend and a function
+        // before its arguments, so a statement with several errors is handed to it for the one it reports. Nothing
+        // was assigned yet, only the root can assign.
+        if (malformed) throw;
+        callStack.clear();
+        return evaluateNode(tree.toNode());
+    }
+    return sweepValues[root];
+}
+
+void Evaluator::sweep(const FlatTree& tree, bool& malformed) {
+    for (uint32_t i = 0; i < tree.size(); ++i) {
+        const FlatTree::Entry& node = tree[i];
+        auto argument = [&](size_t index) {
+            if (index >= node.childCount) {
+                // The tree walk would index past the children, so this error is reported as it is
+                malformed = true;
+                throw std::runtime_error("Missing operand during evaluation.");
+            }
+            uint32_t child = tree.child(i, index);
+            if (child == FlatTree::null) throw std::runtime_error("Encountered a null node during evaluation.");
+            return sweepValues[child];
+        };
+
+        double result;
+        switch (node.type) {
+            case Node::Type::Number:
+                result = node.number;
+                break;
+
+            case Node::Type::Variable: {
+                if (node.op == Node::Op::Pi) { result = M_PI; break; }
+                if (node.op == Node::Op::E) { result = M_E; break; }
+                const double* value = variables.find(node.symbol);
+                if (!value) {
+                    throw std::runtime_error("Undefined variable: '" + tree.name(i) + "'");
+                }
+                result = *value;
+                break;
+            }
+
+            case Node::Type::Assignment:
+                result = argument(0);
+                variables[node.symbol] = result;
+                break;
+
+            case Node::Type::Operand:
+                switch (node.op) {
+                    case Node::Op::Add:
+                        result = node.childCount == 1 ? argument(0) : argument(0) + argument(1);
+                        break;
+                    case Node::Op::Sub: result = argument(0) - argument(1); break;
+                    case Node::Op::Neg: result = -argument(0); break;
+                    case Node::Op::Mul: result = argument(0) * argument(1); break;
+                    case Node::Op::Div:
+                        if (argument(1) == 0) throw std::runtime_error("Division by zero.");
+                        result = argument(0) / argument(1);
+                        break;
+                    case Node::Op::Pow: result = std::pow(argument(0), argument(1)); break;
+                    case Node::Op::Fact: result = factorial(argument(0)); break;
+                    default: throw std::runtime_error("Unknown operand: " + tree.name(i));
+                }
+                break;
+
+            case Node::Type::Function: {
+                switch (node.op) {
+                    case Node::Op::Sin: result = std::sin(argument(0)); break;
+                    case Node::Op::Cos: result = std::cos(argument(0)); break;
+                    case Node::Op::Tan: result = std::tan(argument(0)); break;
+                    case Node::Op::Sqrt: result = std::sqrt(argument(0)); break;
+                    case Node::Op::Log: result = std::log10(argument(0)); break;
+                    case Node::Op::Ln: result = std::log(argument(0)); break;
+                    case Node::Op::Abs: result = std::abs(argument(0)); break;
+                    case Node::Op::Atan2:
+                        if (node.childCount < 2) throw std::runtime_error("atan2 requires two arguments.");
+                        result = std::atan2(argument(0), argument(1));
+                        break;
+                    default: {
+                        const ConstNodePtr* definition = functions.find(node.symbol);
+                        if (!definition) {
+                            throw std::runtime_error("Unknown function: '" + tree.name(i) + "'");
+                        }
+                        const Node* defNode = definition->get();
+                        std::vector<double> evaluatedArgs;
+                        for (size_t c = 0; c < node.childCount; ++c) {
+                            evaluatedArgs.push_back(argument(c));
+                        }
+                        callStack.push_back({evaluatedArgs});
+                        result = evaluateNode(defNode->children[0]);
+                        callStack.pop_back();
+                    }
+                }
+                break;
+            }
+
+            case Node::Type::Parameter:
+                // Function bodies are evaluated as Node trees, so a sweep never runs inside a call
+                throw std::runtime_error("Found a parameter node outside of a function call context.");
+
+            default:
+                throw std::runtime_error("Cannot evaluate this node type.");
+        }
+        sweepValues[i] = result;
+    }
+}
+
+bool Evaluator::evaluateCompiled(const NodePtr& node, double& result) {
+    CompiledStatement* statement = findCompiled(node);
+    // An undefined variable or a failed run is evaluated again by the tree walk, which reports the error
+    if (!statement || !loadSlots(*statement->program)) return false;
+
+    // Native code gives NaN where the bytecode fails, the bytecode tells the two apart
+    if (statement->native) result = (*statement->native)(slotValues.data());
+    if (!statement->native || std::isnan(result)) {
+        const Bytecode& program = *statement->program;
+        scratch.resize(program.getScratchSize());
+        if (!program.run(slotValues.data(), scratch.data(), result)) return false;
+        if (!statement->native && ++statement->runs >= jitThreshold) {
+            if (auto native = JitFunction::compile(program)) statement->native = std::make_shared<const JitFunction>(std::move(*native));
+        }
     }
+    if (node->type == Node::Type::Assignment) variables[node->symbol] = result;
+    compiledEvaluations++;
+    return true;
+}
+
+Evaluator::CompiledStatement* Evaluator::findCompiled(const NodePtr& node) {
+    const bool isAssignment = node->type == Node::Type::Assignment;
+    if (node->type == Node::Type::FunctionAssignment || (isAssignment && node->children.empty())) return nullptr;
+
+    StatementKey key{node};
+    auto it = compiled.find(key);
+    if (it == compiled.end()) {
+        if (!verifyCompiled) {
+            if (evaluatedOnce.size() >= maxCompiledStatements) evaluatedOnce.clear();
+            if (evaluatedOnce.insert(key).second) return nullptr;
+        }
+        if (compiled.size() >= maxCompiledStatements) compiled.clear();
+        it = compiled.emplace(std::move(key), CompiledStatement{functionsVersion - 1, std::nullopt, 0, nullptr}).first;
+    }
+    CompiledStatement& statement = it->second;
+    if (statement.functionsVersion != functionsVersion) {
+        statement.program = Bytecode::compile(isAssignment ? node->children[0].get() : node.get(), functions);
+        statement.functionsVersion = functionsVersion;
+        statement.runs = 0;
+        statement.native.reset();
+        if (statement.program && verifyCompiled) {
+            if (auto native = JitFunction::compile(*statement.program)) statement.native = std::make_shared<const JitFunction>(std::move(*native));
+        }
+    }
+    return statement.program ? &statement : nullptr;
+}
+
+bool Evaluator::loadSlots(const Bytecode& program) {
+    slotValues.resize(program.getSlots().size());
+    for (size_t i = 0; i < slotValues.size(); ++i) {
+        const double* value = variables.find(program.getSlots()[i]);
+        if (!value) return false;
+        slotValues[i] = *value;
+    }
+    return true;
+}
+
+void Evaluator::verify(const NodePtr& node, double expected, const std::vector<std::pair<const char*, double>>& results) {
+    for (const auto& [backend, actual] : results) {
+        // Compared bit for bit, except that any NaN matches any other
+        const bool same = std::isnan(expected) ? std::isnan(actual) : std::memcmp(&expected, &actual, sizeof(double)) == 0;
+        if (!same) compiledMismatches.push_back({node, backend, expected, actual});
+    }
+}
+
+void Evaluator::clearVariable(const std::string& name) {
+    variables.erase(SymbolTable::intern(name));
 }
\ No newline at end of file
@@ -0,0 +1,268 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include "../inc/Jit.hpp"
+
+#include <utility>
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../../Util/inc/ASTUtil.hpp"
+
+using Opcode = Bytecode::Opcode;
+
+/*
+ * Emits the handful of instructions the translation needs. Only xmm0 to xmm2 are used, so no REX prefixes are needed
+ * for them; rbx holds the slot pointer and rsp addresses the frame. Constants are read relative to rip from a pool
+ * placed after the code, their displacements are patched once the code size is known.
+ */
+class Assembler {
+public:
+    std::vector<uint8_t> bytes;
+    std::vector<uint64_t> pool;
+    std::vector<std::pair<size_t, uint32_t>> poolFixups; /* Displacement offset and pool index */
+    std::vector<size_t> failFixups;                      /* Displacements of jumps to the failure exit */
+
+    void emit(std::initializer_list<uint8_t> code) { bytes.insert(bytes.end(), code); }
+
+    void emit32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void patch32(size_t at, uint32_t value) {
+        for (int i = 0; i < 4; ++i) bytes[at + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint32_t addConstant(uint64_t bits) {
+        pool.push_back(bits);
+        return static_cast<uint32_t>(pool.size() - 1);
+    }
+
+    /* movsd xmm, [rsp + offset] */
+    void loadFrame(int xmm, uint32_t offset) {
+        emit({0xF2, 0x0F, 0x10, static_cast<uint8_t>(0x84 | xmm << 3), 0x24});
+        emit32(offset);
+    }
+
+    /* movsd [rsp + offset], xmm0 */
+    void storeFrame(uint32_t offset) {
+        emit({0xF2, 0x0F, 0x11, 0x84, 0x24});
+        emit32(offset);
+    }
+
+    /* movsd xmm0, [rbx + offset] */
+    void loadSlot(uint32_t offset) {
+        emit({0xF2, 0x0F, 0x10, 0x83});
+        emit32(offset);
+    }
+
+    /* movsd xmm, [rip + pool entry] */
+    void loadConstant(int xmm, uint32_t index) {
+        emit({0xF2, 0x0F, 0x10, static_cast<uint8_t>(0x05 | xmm << 3)});
+        poolFixups.emplace_back(bytes.size(), index);
+        emit32(0);
+    }
+
+    /* Calls a function taking its arguments in xmm0 and xmm1 and returning in xmm0 */
+    void call(const void *function) {
+        emit({0x48, 0xB8}); /* mov rax, imm64 */
+        const auto address = reinterpret_cast<uint64_t>(function);
+        for (int i = 0; i < 8; ++i) bytes.push_back(static_cast<uint8_t>(address >> (8 * i)));
+        emit({0xFF, 0xD0}); /* call rax */
+    }
+
+    /* Jumps to the failure exit if xmm1 equals zero, NaN compares unordered and falls through */
+    void failIfDivisorIsZero() {
+        emit({0x66, 0x0F, 0x57, 0xD2}); /* xorpd xmm2, xmm2 */
+        emit({0x66, 0x0F, 0x2E, 0xCA}); /* ucomisd xmm1, xmm2 */
+        emit({0x7A, 0x06});             /* jp over the je */
+        emit({0x0F, 0x84});             /* je rel32 */
+        failFixups.push_back(bytes.size());
+        emit32(0);
+    }
+
+    void epilogue(uint32_t frameSize) {
+        emit({0x48, 0x81, 0xC4}); /* add rsp, imm32 */
+        emit32(frameSize);
+        emit({0x5B, 0xC3});       /* pop rbx; ret */
+    }
+};
+
+static uint64_t toBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static const void *getFunction(Opcode opcode) {
+    using Unary = double (*)(double);
+    using Binary = double (*)(double, double);
+    switch (opcode) {
+        case Opcode::Pow: return reinterpret_cast<const void *>(static_cast<Binary>(std::pow));
+        case Opcode::Atan2: return reinterpret_cast<const void *>(static_cast<Binary>(std::atan2));
+        case Opcode::Fact: return reinterpret_cast<const void *>(&factorial);
+        case Opcode::Sin: return reinterpret_cast<const void *>(static_cast<Unary>(std::sin));
+        case Opcode::Cos: return reinterpret_cast<const void *>(static_cast<Unary>(std::cos));
+        case Opcode::Tan: return reinterpret_cast<const void *>(static_cast<Unary>(std::tan));
+        case Opcode::Log: return reinterpret_cast<const void *>(static_cast<Unary>(std::log10));
+        case Opcode::Ln: return reinterpret_cast<const void *>(static_cast<Unary>(std::log));
+        default: return nullptr;
+    }
+}
+
+/* Translates the program with the stack depth of every instruction known, xmm0 caching the top where it can */
+static std::vector<uint8_t> translate(const Bytecode &program) {
+    Assembler a;
+    const uint32_t localCount = program.getLocalCount();
+    const auto frameSize = static_cast<uint32_t>((program.getScratchSize() * sizeof(double) + 15) & ~size_t(15));
+    auto stack = [&](uint32_t depth) { return (localCount + depth) * static_cast<uint32_t>(sizeof(double)); };
+
+    std::vector<uint32_t> constants;
+    for (double constant: program.getConstants()) constants.push_back(a.addConstant(toBits(constant)));
+    const uint32_t signMask = a.addConstant(0x8000000000000000ULL);
+    const uint32_t absMask = a.addConstant(0x7FFFFFFFFFFFFFFFULL);
+    const uint32_t nan = a.addConstant(toBits(NAN));
+
+    /* push rbx keeps rsp 16-byte aligned for calls together with a frame size that is a multiple of 16 */
+    a.emit({0x53});             /* push rbx */
+    a.emit({0x48, 0x89, 0xFB}); /* mov rbx, rdi */
+    a.emit({0x48, 0x81, 0xEC}); /* sub rsp, imm32 */
+    a.emit32(frameSize);
+
+    uint32_t depth = 0;
+    bool topInXmm0 = false;
+    for (const Bytecode::Instruction &instruction: program.getCode()) {
+        const Opcode opcode = instruction.opcode;
+        switch (opcode) {
+            case Opcode::Constant:
+                a.loadConstant(0, constants[instruction.operand]);
+                a.storeFrame(stack(depth++));
+                topInXmm0 = true;
+                break;
+            case Opcode::Load:
+                a.loadSlot(instruction.operand * sizeof(double));
+                a.storeFrame(stack(depth++));
+                topInXmm0 = true;
+                break;
+            case Opcode::LoadLocal:
+                a.loadFrame(0, instruction.operand * sizeof(double));
+                a.storeFrame(stack(depth++));
+                topInXmm0 = true;
+                break;
+            case Opcode::StoreLocal:
+                if (!topInXmm0) a.loadFrame(0, stack(depth - 1));
+                a.storeFrame(instruction.operand * sizeof(double));
+                depth--;
+                topInXmm0 = false;
+                break;
+
+            case Opcode::Add: case Opcode::Sub: case Opcode::Mul: case Opcode::Div: case Opcode::Pow:
+            case Opcode::Atan2:
+                if (topInXmm0) {
+                    a.emit({0x66, 0x0F, 0x28, 0xC8}); /* movapd xmm1, xmm0 */
+                } else {
+                    a.loadFrame(1, stack(depth - 1));
+                }
+                a.loadFrame(0, stack(depth - 2));
+                switch (opcode) {
+                    case Opcode::Add: a.emit({0xF2, 0x0F, 0x58, 0xC1}); break; /* addsd xmm0, xmm1 */
+                    case Opcode::Sub: a.emit({0xF2, 0x0F, 0x5C, 0xC1}); break; /* subsd xmm0, xmm1 */
+                    case Opcode::Mul: a.emit({0xF2, 0x0F, 0x59, 0xC1}); break; /* mulsd xmm0, xmm1 */
+                    case Opcode::Div:
+                        a.failIfDivisorIsZero();
+                        a.emit({0xF2, 0x0F, 0x5E, 0xC1}); /* divsd xmm0, xmm1 */
+                        break;
+                    default: a.call(getFunction(opcode));
+                }
+                a.storeFrame(stack(--depth - 1));
+                topInXmm0 = true;
+                break;
+
+            default:
+                if (!topInXmm0) a.loadFrame(0, stack(depth - 1));
+                switch (opcode) {
+                    case Opcode::Neg:
+                        a.loadConstant(1, signMask);
+                        a.emit({0x66, 0x0F, 0x57, 0xC1}); /* xorpd xmm0, xmm1 */
+                        break;
+                    case Opcode::Abs:
+                        a.loadConstant(1, absMask);
+                        a.emit({0x66, 0x0F, 0x54, 0xC1}); /* andpd xmm0, xmm1 */
+                        break;
+                    case Opcode::Sqrt: a.emit({0xF2, 0x0F, 0x51, 0xC0}); break; /* sqrtsd xmm0, xmm0 */
+                    default: a.call(getFunction(opcode));
+                }
+                a.storeFrame(stack(depth - 1));
+                topInXmm0 = true;
+        }
+    }
+    if (!topInXmm0) a.loadFrame(0, stack(depth - 1));
+    a.epilogue(frameSize);
+
+    const size_t failExit = a.bytes.size();
+    a.loadConstant(0, nan);
+    a.epilogue(frameSize);
+
+    while (a.bytes.size() % sizeof(uint64_t)) a.emit({0xCC});
+    const size_t poolStart = a.bytes.size();
+    for (uint64_t bits: a.pool)
+        for (int i = 0; i < 8; ++i) a.bytes.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+
+    /* Displacements are relative to the end of the instruction, which their four bytes end */
+    for (auto [at, index]: a.poolFixups)
+        a.patch32(at, static_cast<uint32_t>(poolStart + index * sizeof(uint64_t) - (at + 4)));
+    for (size_t at: a.failFixups) a.patch32(at, static_cast<uint32_t>(failExit - (at + 4)));
+    return a.bytes;
+}
+
+std::optional<JitFunction> JitFunction::compile(const Bytecode &program) {
+    const std::vector<uint8_t> code = translate(program);
+    const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t size = (code.size() + pageSize - 1) / pageSize * pageSize;
+
+    /* Written while writable and only then made executable, the pages are never both */
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return std::nullopt;
+    std::memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return std::nullopt;
+    }
+    return JitFunction(memory, size);
+}
+
+JitFunction::~JitFunction() {
+    if (memory) munmap(memory, size);
+}
+
+#else
+
+std::optional<JitFunction> JitFunction::compile(const Bytecode &) {
+    return std::nullopt;
+}
+
+JitFunction::~JitFunction() = default;
+
+#endif
+
+JitFunction::JitFunction(void *memory, size_t size)
+    : memory(memory), size(size), entry(reinterpret_cast<Entry>(memory)) {
+}
+
+JitFunction::JitFunction(JitFunction &&other) noexcept
+    : memory(std::exchange(other.memory, nullptr)), size(other.size), entry(other.entry) {
+}
+
+JitFunction &JitFunction::operator=(JitFunction &&other) noexcept {
+    std::swap(memory, other.memory);
+    std::swap(size, other.size);
+    std::swap(entry, other.entry);
+    return *this;
+}
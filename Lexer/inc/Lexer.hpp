@@ -4,36 +4,59 @@
 
 #pragma once
 
-#include <regex>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "../../Token/inc/Token.hpp"
 
 class Lexer {
+    /* Computed once per token vector so nesting queries do not rescan it. Entries equal the vector size when there is no match. */
+    struct Lookahead {
+        std::vector<size_t> closing; /* First unmatched ')' at or after each token */
+        std::vector<size_t> comma;   /* First ',' at or after each token on its own nesting level */
+        explicit Lookahead(const std::vector<Token> &tokens);
+    };
+
     std::string error;
-    std::vector<Token> tokens;
-    static inline Token Eof{Token::Type::Eof, "", 0, 0, ""};
-    explicit Lexer(const std::vector<Token>& tokens);
+    std::shared_ptr<const Source> source;
+    std::shared_ptr<const std::vector<Token>> tokens;
+    std::shared_ptr<const Lookahead> lookahead;
+    size_t cursor = 0;
+    size_t end = 0;
+    /* Token pushed in front of the cursor by the parser (implicit '*'), never stored in tokens. */
+    Token virtualToken{Token::Type::Eof, "", 0, 0, nullptr};
+    bool hasVirtualToken = false;
+    static inline Token Eof{Token::Type::Eof, "", 0, 0, nullptr};
+    static constexpr size_t minParallelChunkSize = 256 * 1024;
+    Lexer(std::shared_ptr<const std::vector<Token>> tokens, std::shared_ptr<const Lookahead> lookahead, size_t begin, size_t end, std::shared_ptr<const Source> source);
 
 public:
-    explicit Lexer(const std::string &input);
+    explicit Lexer(const std::string &input, int firstLine = 1);
+
+    /* Lexes large inputs in newline-aligned chunks on up to threadCount threads. Same tokens and errors as Lexer(input). */
+    static Lexer createParallel(const std::string &input, unsigned threadCount = std::thread::hardware_concurrency());
 
-    Lexer getSubLexer(int pos);
+    Lexer getSubLexer(int pos) const;
 
     [[nodiscard]] std::string getError() const;
 
-    [[nodiscard]] Token peek(int n = 0) const;
+    [[nodiscard]] const Token &peek(int n = 0) const;
 
     [[nodiscard]] Token next();
 
     void skip(int n = 1);
 
-    void addToken(const Token &token);
+    [[nodiscard]] size_t getRemainingTokenCount() const;
+
+    void addVirtualToken(const Token &token);
 
-    int getIndexFirstInstance(Token::Type type);
+    [[nodiscard]] int getIndexFirstInstance(Token::Type type) const;
 
-    int getClosingParenthesesIndex() const;
+    /* Index of the ')' closing the group that peek(n) is in, -1 if it is not closed before the end */
+    [[nodiscard]] int getClosingParenthesesIndex(int n = 0) const;
 
-    void removeToken(int pos);
+    /* Index of the next ',' that is not nested deeper than peek(0), -1 if there is none */
+    [[nodiscard]] int getNextCommaIndex() const;
 };
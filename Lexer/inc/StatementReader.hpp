@@ -0,0 +1,20 @@
+//
+// Created by Erhan Türker on 10/16/26.
+//
+
+#pragma once
+
+#include <istream>
+#include <string>
+
+/* Splits a script read from a stream into top-level statements, one line at a time. */
+class StatementReader {
+    std::istream &input;
+    int line = 1;
+
+public:
+    explicit StatementReader(std::istream &input);
+
+    /* Reads lines, newlines included, until every '(' opened on them is closed. Returns false once the input is exhausted. */
+    bool next(std::string &statement, int &firstLine);
+};
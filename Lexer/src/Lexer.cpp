@@ -1,138 +1,321 @@
 #include "../inc/Lexer.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
 #include <iostream>
 #include <sstream>
+#include <string_view>
+#include <thread>
 #include <utility>
 
 using Type = Token::Type;
 
-Lexer::Lexer(const std::string &input) {
-    std::vector<std::pair<Type, std::regex> > token_specification = {
-        {Type::Skip, std::regex(R"(#.*)")},
-        {Type::Number, std::regex(R"(\d+(\.\d*)?([eE][+-]?\d+)?)")},
-        {Type::Derivative, std::regex(R"((d/d((_\w*)|([a-zA-Z]_\w*)|([a-zA-Z]))))")},
-        {Type::Word, std::regex(R"((\b(pi|sin|cos|tan|log|ln|sqrt|abs|atan2)\b))")},
-        {Type::Word, std::regex(R"((_\w*)|([a-zA-Z]_\w*)|([a-zA-Z]))")},
-        {Type::Symbol, std::regex(R"([!=\+\-\*/\^\(\)])")},
-        {Type::Newline, std::regex(R"(\n)")},
-        {Type::Skip, std::regex(R"([ \t\r]+)")},
-        {Type::Comma, std::regex(R"(,)")},
-    };
+static bool isDigit(const char c) {
+    return c >= '0' && c <= '9';
+}
 
-    size_t position = 0;
-    int line_number = 1;
-
-    while (position < input.length()) {
-        bool matched = false;
-        for (const auto &[type, re]: token_specification) {
-            std::smatch match;
-            if (std::regex_search(input.cbegin() + position, input.cend(), match, re,
-                                  std::regex_constants::match_continuous)) {
-                if (type == Type::Newline) {
-                    size_t line_start = input.rfind('\n', position - 1);
-                    line_start = (line_start == std::string::npos) ? 0 : line_start + 1;
-
-                    std::string line_content = input.substr(line_start, position - line_start);
-
-                    size_t column = position - line_start;
-
-                    tokens.emplace_back(type, match.str(), line_number, column, line_content);
-                    line_number++;
-                } else if (type != Type::Skip) {
-                    size_t line_start = input.rfind('\n', position);
-                    line_start = (line_start == std::string::npos) ? 0 : line_start + 1;
-                    size_t line_end = input.find('\n', position);
-                    line_end = (line_end == std::string::npos) ? input.length() : line_end;
-                    std::string line_content = input.substr(line_start, line_end - line_start);
-
-                    tokens.emplace_back(type, match.str(), line_number, position - line_start, line_content);
-                }
+static bool isAlpha(const char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static bool isWordChar(const char c) {
+    return isAlpha(c) || isDigit(c) || c == '_';
+}
+
+/* \d+(\.\d*)?([eE][+-]?\d+)? */
+static size_t scanNumber(const std::string &input, size_t pos) {
+    const size_t begin = pos;
+    while (pos < input.length() && isDigit(input[pos])) pos++;
+    if (pos < input.length() && input[pos] == '.') {
+        pos++;
+        while (pos < input.length() && isDigit(input[pos])) pos++;
+    }
+    if (pos < input.length() && (input[pos] == 'e' || input[pos] == 'E')) {
+        size_t exp = pos + 1;
+        if (exp < input.length() && (input[exp] == '+' || input[exp] == '-')) exp++;
+        if (exp < input.length() && isDigit(input[exp])) {
+            while (exp < input.length() && isDigit(input[exp])) exp++;
+            pos = exp;
+        }
+    }
+    return pos - begin;
+}
+
+static double parseNumber(std::string_view literal) {
+    double value = 0.0;
+    auto [ptr, ec] = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+    if (ec == std::errc::result_out_of_range) {
+        /* Let strtod pick between inf and denormal/zero like stod used to */
+        value = std::strtod(std::string(literal).c_str(), nullptr);
+    }
+    return value;
+}
+
+/* (_\w*)|([a-zA-Z]_\w*)|([a-zA-Z]) */
+static size_t scanIdentifier(const std::string &input, size_t pos) {
+    const size_t begin = pos;
+    if (pos >= input.length()) return 0;
+    if (input[pos] == '_' || (isAlpha(input[pos]) && pos + 1 < input.length() && input[pos + 1] == '_')) {
+        pos += input[pos] == '_' ? 1 : 2;
+        while (pos < input.length() && isWordChar(input[pos])) pos++;
+        return pos - begin;
+    }
+    return isAlpha(input[pos]) ? 1 : 0;
+}
 
-                position += match.length();
-                matched = true;
+/* \b(pi|sin|cos|tan|log|ln|sqrt|abs|atan2)\b */
+static size_t scanKeyword(const std::string &input, size_t pos) {
+    static constexpr std::string_view keywords[] = {"pi", "sin", "cos", "tan", "log", "ln", "sqrt", "abs", "atan2"};
+    const std::string_view rest = std::string_view(input).substr(pos);
+    for (const auto &keyword: keywords) {
+        if (rest.starts_with(keyword) && (rest.length() == keyword.length() || !isWordChar(rest[keyword.length()])))
+            return keyword.length();
+    }
+    return 0;
+}
+
+/* d/d followed by an identifier */
+static size_t scanDerivative(const std::string &input, size_t pos) {
+    if (input.compare(pos, 3, "d/d") != 0) return 0;
+    const size_t var = scanIdentifier(input, pos + 3);
+    return var ? var + 3 : 0;
+}
+
+/* Scans text[begin, end) of source, where begin is the start of line firstLine. Returns the error, empty on success. */
+static std::string scan(const Source &source, size_t begin, size_t end, int firstLine, std::vector<Token> &scanned) {
+    const std::string &text = source.text;
+    size_t position = begin;
+    size_t line_start = begin;
+    int line_number = firstLine;
+
+    while (position < end) {
+        const char c = text[position];
+        Type type = Type::Skip;
+        size_t length = 0;
+
+        switch (c) {
+            case '#':
+                length = 1;
+                while (position + length < text.length()
+                       && text[position + length] != '\n' && text[position + length] != '\r') length++;
                 break;
-            }
+            case ' ': case '\t': case '\r':
+                length = 1;
+                while (position + length < text.length()) {
+                    const char ws = text[position + length];
+                    if (ws != ' ' && ws != '\t' && ws != '\r') break;
+                    length++;
+                }
+                break;
+            case '!': case '=': case '+': case '-': case '*': case '/': case '^': case '(': case ')':
+                type = Type::Symbol;
+                length = 1;
+                break;
+            case '\n':
+                type = Type::Newline;
+                length = 1;
+                break;
+            case ',':
+                type = Type::Comma;
+                length = 1;
+                break;
+            default:
+                if (isDigit(c)) {
+                    type = Type::Number;
+                    length = scanNumber(text, position);
+                } else if ((length = scanDerivative(text, position))) {
+                    type = Type::Derivative;
+                } else if ((length = scanKeyword(text, position))) {
+                    type = Type::Word;
+                } else if ((length = scanIdentifier(text, position))) {
+                    type = Type::Word;
+                }
         }
-        if (!matched) {
-            size_t line_start = input.rfind('\n', position);
-            line_start = (line_start == std::string::npos) ? 0 : line_start + 1;
-            size_t line_end = input.find('\n', position);
-            std::string line_content = input.substr(line_start, line_end - line_start);
 
-            std::string offending(1, input[position]);
+        if (!length) {
+            std::string offending(1, c);
             std::ostringstream err_oss;
             err_oss << "Unexpected character \"" << offending << "\" at line " << line_number <<
                     ", column " << (position - line_start) << ".\n";
-            err_oss << "    " << line_content << "\n";
+            err_oss << "    " << source.getLine(line_number) << "\n";
             err_oss << "    " << std::string(position - line_start, ' ') << "^-- This should not be here.";
-            error = err_oss.str();
-            tokens.clear();
-            return;
+            return err_oss.str();
         }
+
+        if (type != Type::Skip) {
+            scanned.emplace_back(type, std::string_view(text).substr(position, length), line_number,
+                                position - line_start, &source);
+            if (type == Type::Number) scanned.back().number = parseNumber(scanned.back().value);
+            if (type == Type::Word && scanned.back().symbol == SymbolTable::empty) {
+                std::ostringstream err_oss;
+                err_oss << "Too many names, \"" << scanned.back().value << "\" at line " << line_number <<
+                        ", column " << (position - line_start) << " is not known yet.\n";
+                err_oss << "    " << source.getLine(line_number) << "\n";
+                err_oss << "    " << std::string(position - line_start, ' ') << "^-- Use a name from earlier input.";
+                return err_oss.str();
+            }
+        }
+
+        position += length;
+        if (type == Type::Newline) {
+            line_number++;
+            line_start = position;
+        }
+    }
+    return "";
+}
+
+Lexer::Lexer(const std::string &input, int firstLine) : source(std::make_shared<const Source>(input, firstLine)) {
+    std::vector<Token> scanned;
+    error = scan(*source, 0, source->text.length(), firstLine, scanned);
+    if (!error.empty()) scanned.clear();
+    end = scanned.size();
+    lookahead = std::make_shared<const Lookahead>(scanned);
+    tokens = std::make_shared<const std::vector<Token>>(std::move(scanned));
+}
+
+Lexer::Lookahead::Lookahead(const std::vector<Token> &tokens) : closing(tokens.size()), comma(tokens.size()) {
+    const size_t none = tokens.size();
+    auto at = [&](const std::vector<size_t> &table, size_t i) { return i < none ? table[i] : none; };
+    for (size_t i = tokens.size(); i-- > 0;) {
+        const Token &token = tokens[i];
+        if (token.type == Type::Symbol && token.value[0] == ')') {
+            closing[i] = i;
+            comma[i] = none;
+        } else if (token.type == Type::Symbol && token.value[0] == '(') {
+            /* Jump over the group to whatever follows its closing parenthesis */
+            const size_t close = at(closing, i + 1);
+            closing[i] = close < none ? at(closing, close + 1) : none;
+            comma[i] = close < none ? at(comma, close + 1) : none;
+        } else {
+            closing[i] = at(closing, i + 1);
+            comma[i] = token.type == Type::Comma ? i : at(comma, i + 1);
+        }
+    }
+}
+
+Lexer Lexer::createParallel(const std::string &input, unsigned threadCount) {
+    auto source = std::make_shared<const Source>(input);
+    const size_t length = source->text.length();
+    const auto &lineStarts = source->lineStarts;
+
+    /* Chunks start at line starts, so no token or comment crosses a boundary and the line table gives each chunk's line */
+    const size_t chunkCount = std::clamp<size_t>(length / minParallelChunkSize, 1, std::max(threadCount, 1u));
+    std::vector<size_t> boundaries{0};
+    for (size_t i = 1; i < chunkCount; ++i) {
+        auto it = std::lower_bound(lineStarts.begin(), lineStarts.end(), i * length / chunkCount);
+        if (it != lineStarts.end() && *it > boundaries.back() && *it < length) boundaries.push_back(*it);
+    }
+    boundaries.push_back(length);
+
+    const size_t chunks = boundaries.size() - 1;
+    std::vector<std::vector<Token>> scanned(chunks);
+    std::vector<std::string> errors(chunks);
+    auto scanChunk = [&](size_t i) {
+        const auto line = std::lower_bound(lineStarts.begin(), lineStarts.end(), boundaries[i]) - lineStarts.begin();
+        errors[i] = scan(*source, boundaries[i], boundaries[i + 1], static_cast<int>(line) + 1, scanned[i]);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunks; ++i) workers.emplace_back(scanChunk, i);
+    scanChunk(0);
+    for (auto &worker: workers) worker.join();
+
+    size_t total = 0;
+    for (const auto &chunk: scanned) total += chunk.size();
+    std::vector<Token> merged;
+    merged.reserve(total);
+    std::string error;
+    for (size_t i = 0; i < chunks; ++i) {
+        if (!errors[i].empty()) {
+            error = errors[i];
+            merged.clear();
+            break;
+        }
+        merged.insert(merged.end(), scanned[i].begin(), scanned[i].end());
     }
 
-    error = "";
-    this->tokens = std::vector<Token>{this->tokens.rbegin(), this->tokens.rend()};
+    const size_t end = merged.size();
+    auto lookahead = std::make_shared<const Lookahead>(merged);
+    Lexer lexer(std::make_shared<const std::vector<Token>>(std::move(merged)), std::move(lookahead), 0, end, std::move(source));
+    lexer.error = error;
+    return lexer;
+}
+
+Lexer::Lexer(std::shared_ptr<const std::vector<Token>> tokens, std::shared_ptr<const Lookahead> lookahead, size_t begin, size_t end, std::shared_ptr<const Source> source)
+    : source(std::move(source)), tokens(std::move(tokens)), lookahead(std::move(lookahead)), cursor(begin), end(end) {
 }
 
-Token Lexer::peek(int n) const {
-    if (tokens.size() <= n)
+const Token &Lexer::peek(int n) const {
+    if (hasVirtualToken) {
+        if (n == 0) return virtualToken;
+        n--;
+    }
+    if (cursor + n >= end)
         return Eof;
-    return tokens[tokens.size() - 1 - n];
+    return (*tokens)[cursor + n];
 }
 
 Token Lexer::next() {
-    if (tokens.empty()) return Eof;
-    Token token = tokens.back();
-    tokens.pop_back();
-    return token;
+    if (hasVirtualToken) {
+        hasVirtualToken = false;
+        return virtualToken;
+    }
+    if (cursor >= end) return Eof;
+    return (*tokens)[cursor++];
 }
 
 void Lexer::skip(int n) {
-    for (size_t i = 0; i < n; i++) {
-    tokens.pop_back();
+    if (n > 0 && hasVirtualToken) {
+        hasVirtualToken = false;
+        n--;
     }
+    cursor = std::min(cursor + n, end);
+}
+
+size_t Lexer::getRemainingTokenCount() const {
+    return end - cursor + (hasVirtualToken ? 1 : 0);
 }
 
-Lexer Lexer::getSubLexer(int pos) {
-    return Lexer(std::vector<Token>{tokens.begin() + static_cast<int>(tokens.size()) - pos, tokens.end()});
+Lexer Lexer::getSubLexer(int pos) const {
+    if (hasVirtualToken && pos > 0) {
+        Lexer subLexer(tokens, lookahead, cursor, cursor + pos - 1, source);
+        subLexer.addVirtualToken(virtualToken);
+        return subLexer;
+    }
+    return Lexer(tokens, lookahead, cursor, cursor + pos, source);
 }
 
-void Lexer::addToken(const Token &token) {
-    tokens.push_back(token);
+void Lexer::addVirtualToken(const Token &token) {
+    virtualToken = token;
+    hasVirtualToken = true;
 }
 
 std::string Lexer::getError() const {
     return error;
 }
 
-Lexer::Lexer(const std::vector<Token>& tokens)
-    : tokens(tokens) {
-}
-
-int Lexer::getIndexFirstInstance(Token::Type type) {
-    for (int i = static_cast<int>(tokens.size()) - 1; i >= 0; --i) {
-        if (tokens[i].type == type) {
-            return static_cast<int>(tokens.size()) - i - 1;
+int Lexer::getIndexFirstInstance(Token::Type type) const {
+    const int offset = hasVirtualToken ? 1 : 0;
+    if (hasVirtualToken && virtualToken.type == type) return 0;
+    for (size_t i = cursor; i < end; ++i) {
+        if ((*tokens)[i].type == type) {
+            return static_cast<int>(i - cursor) + offset;
         }
     }
     return -1;
 }
 
-void Lexer::removeToken(int pos) {
-    tokens.erase(tokens.begin() + static_cast<int>(tokens.size()) - pos - 1);
+int Lexer::getClosingParenthesesIndex(int n) const {
+    const int offset = hasVirtualToken ? 1 : 0; /* The virtual token is never a parenthesis */
+    const size_t from = cursor + std::max(n - offset, 0);
+    if (from >= end || lookahead->closing[from] >= end) return -1;
+    return static_cast<int>(lookahead->closing[from] - cursor) + offset;
 }
 
-int Lexer::getClosingParenthesesIndex() const {
-    int plCnt = 0;
-    for (int i = static_cast<int>(tokens.size()) - 1; i >= 0; --i) {
-        if (tokens[i].type == Type::Symbol && tokens[i].value[0] == '(') {
-            plCnt++;
-        }
-        if (tokens[i].type == Type::Symbol && tokens[i].value[0] == ')') {
-            if (!plCnt--)
-                return static_cast<int>(tokens.size()) - i - 1;
-        }
-    }
-    return -1;
+int Lexer::getNextCommaIndex() const {
+    const int offset = hasVirtualToken ? 1 : 0;
+    if (cursor >= end || lookahead->comma[cursor] >= end) return -1;
+    return static_cast<int>(lookahead->comma[cursor] - cursor) + offset;
 }
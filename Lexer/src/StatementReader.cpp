@@ -0,0 +1,29 @@
+//
+// Created by Erhan Türker on 10/16/26.
+//
+
+#include "../inc/StatementReader.hpp"
+
+StatementReader::StatementReader(std::istream &input) : input(input) {
+}
+
+bool StatementReader::next(std::string &statement, int &firstLine) {
+    statement.clear();
+    firstLine = line;
+    std::string current;
+    int parenthesesLevel = 0;
+
+    while (std::getline(input, current)) {
+        line++;
+        statement += current;
+        if (!input.eof()) statement += '\n'; /* Keep the terminator, the parser reports some errors against it */
+
+        for (const char c: current) {
+            if (c == '#') break;
+            if (c == '(') parenthesesLevel++;
+            if (c == ')' && parenthesesLevel > 0) parenthesesLevel--;
+        }
+        if (parenthesesLevel == 0) return true;
+    }
+    return !statement.empty();
+}
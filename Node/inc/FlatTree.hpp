@@ -0,0 +1,50 @@
+//
+// Created by Erhan Türker on 10/16/26.
+//
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Node.hpp"
+
+/*
+ * Contiguous form of a Node tree. Nodes are stored in post-order with the root last, so every child comes before
+ * its parent and a single forward sweep visits them bottom-up. Children are 32-bit indices into a shared table.
+ */
+class FlatTree {
+public:
+    static constexpr uint32_t null = UINT32_MAX; /* Index of a missing child */
+
+    struct Entry {
+        double number;       /* Value of Number nodes */
+        SymbolId symbol;
+        uint32_t firstChild; /* Offset of the child indices in the child table */
+        uint32_t childCount;
+        Node::Type type;
+        Node::Op op;
+    };
+
+    /* Handle to one node, passed by value where the Node functions take a pointer */
+    struct Ref {
+        const FlatTree *tree;
+        uint32_t index;
+    };
+
+    static FlatTree fromNode(const NodePtr &root);
+    [[nodiscard]] NodePtr toNode() const;
+
+    [[nodiscard]] size_t size() const { return nodes.size(); }
+    [[nodiscard]] bool empty() const { return nodes.empty(); }
+    [[nodiscard]] Ref root() const { return {this, nodes.empty() ? null : static_cast<uint32_t>(nodes.size() - 1)}; }
+
+    [[nodiscard]] const Entry &operator[](uint32_t index) const { return nodes[index]; }
+    [[nodiscard]] uint32_t child(uint32_t index, size_t i) const { return childIndices[nodes[index].firstChild + i]; }
+    [[nodiscard]] const std::string &name(uint32_t index) const { return SymbolTable::name(nodes[index].symbol); }
+
+private:
+    std::vector<Entry> nodes;
+    std::vector<uint32_t> childIndices;
+};
@@ -3,26 +3,108 @@
 //
 
 #pragma once
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include "../../Lexer/inc/Lexer.hpp"
+#include "SmallVector.hpp"
 
 class Parser;
 
+/*
+ * Owning pointer to a Node, counted in the node itself without atomics. Nodes must not be shared between threads;
+ * ownership may be handed over across a join, and FlatTree or a serialized AST is the snapshot to share instead.
+ */
+template<typename T>
+class BasicNodePtr {
+    template<typename> friend class BasicNodePtr;
+    T *node = nullptr;
+
+    void release() {
+        T *released = std::exchange(node, nullptr);
+        if (released && --released->references.count == 0) delete released;
+    }
+
+public:
+    BasicNodePtr() = default;
+    BasicNodePtr(std::nullptr_t) {}
+    explicit BasicNodePtr(T *node) : node(node) { if (node) node->references.count++; }
+    BasicNodePtr(const BasicNodePtr &other) : BasicNodePtr(other.node) {}
+    BasicNodePtr(BasicNodePtr &&other) noexcept : node(std::exchange(other.node, nullptr)) {}
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    BasicNodePtr(const BasicNodePtr<U> &other) : BasicNodePtr(other.node) {}
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    BasicNodePtr(BasicNodePtr<U> &&other) noexcept : node(std::exchange(other.node, nullptr)) {}
+    ~BasicNodePtr() { release(); }
+
+    BasicNodePtr &operator=(BasicNodePtr other) noexcept { std::swap(node, other.node); return *this; }
+    void reset() { BasicNodePtr().swap(*this); }
+    void swap(BasicNodePtr &other) noexcept { std::swap(node, other.node); }
+
+    T *get() const { return node; }
+    T &operator*() const { return *node; }
+    T *operator->() const { return node; }
+    explicit operator bool() const { return node != nullptr; }
+
+    template<typename U>
+    bool operator==(const BasicNodePtr<U> &other) const { return node == other.node; }
+    bool operator==(std::nullptr_t) const { return node == nullptr; }
+};
+
+struct Node;
+using NodePtr = BasicNodePtr<Node>;
+using ConstNodePtr = BasicNodePtr<const Node>;
+
 struct Node {
-    enum class Type { Number, Variable, Operand, Function, Assignment, FunctionAssignment, Parameter, FunctionExpression, Derivative};
+    enum class Type : uint8_t { Number, Variable, Operand, Function, Assignment, FunctionAssignment, Parameter, FunctionExpression, Derivative};
+    /* Built-in operation of an Operand, predefined Function or constant Variable, None for names defined by the user */
+    enum class Op : uint8_t { None, Add, Sub, Mul, Div, Pow, Fact, Neg, Sin, Cos, Tan, Log, Ln, Sqrt, Abs, Atan2, Pi, E };
+
+    /* Number of NodePtrs to the node, a copied node starts unowned */
+    struct RefCount {
+        uint32_t count = 0;
+        RefCount() = default;
+        RefCount(const RefCount &) {}
+        RefCount &operator=(const RefCount &) { return *this; }
+    };
+    /* Operators and calls with up to two arguments keep their children inside the node */
+    using Children = SmallVector<NodePtr, 2>;
 
     Type type;
-    std::string value;
-    std::vector<std::shared_ptr<Node>> children;
+    Op op; /* Derived from type and name, except that a unary minus is Neg instead of Sub */
+    mutable RefCount references;
+    SymbolId symbol; /* Interned name, operator or parameter; empty for Number nodes */
+    double number = 0.0; /* Value of Number nodes; ASTPrint formats it */
+    Children children;
+    mutable uint64_t hash = 0; /* Cached by getHash, 0 until computed */
 
-    Node(Type t, std::string v) : type(t), value(std::move(v)) {}
+    Node(Type t, SymbolId s, double n = 0.0) : type(t), op(getOp(t, SymbolTable::name(s))), symbol(s), number(n) {}
+    Node(Type t, std::string_view name, double n = 0.0) : Node(t, SymbolTable::intern(name), n) {}
 
-    static std::shared_ptr<Node> createNode(const Token &token, const Parser& parser);
-    static std::shared_ptr<Node> createNode(const Token &token);
-    static std::shared_ptr<Node> createNode(double value);
+    static NodePtr createNode(const Token &token, const Parser& parser);
+    static NodePtr createNode(const Token &token);
+    static NodePtr createNode(double value);
+    static NodePtr createNegation(NodePtr operand);
+    static Op getOp(Type type, std::string_view name);
+
+    [[nodiscard]] const std::string &name() const { return SymbolTable::name(symbol); }
+
+    /* Structural hash over the subtree, computed once and cached in every node it covers. A node is immutable once
+       it is hashed or shared, so transformations build changed nodes with withChildren and keep their input intact. */
+    [[nodiscard]] uint64_t getHash() const;
+    /* Structural equality; hashes only reject early, so colliding trees still compare unequal */
+    static bool equal(const Node *a, const Node *b);
 
     template<typename Func>
     void apply(Func fun) {fun(this); for (const auto& child : children) if (child) child->apply(fun);}
-    [[nodiscard]] std::shared_ptr<Node> clone() const;
+    [[nodiscard]] NodePtr clone() const;
+    /* Unhashed copy of this node alone over the given children */
+    [[nodiscard]] NodePtr withChildren(Children children) const;
 };
+
+template<typename... Args>
+NodePtr makeNode(Args &&... args) {
+    return NodePtr(new Node(std::forward<Args>(args)...));
+}
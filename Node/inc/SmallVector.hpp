@@ -0,0 +1,142 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <utility>
+
+/*
+ * Vector that keeps up to N elements inside the object and only allocates once it grows past them.
+ * Supports the subset of std::vector the AST uses.
+ */
+template<typename T, size_t N>
+class SmallVector {
+    union Storage {
+        Storage() {}
+        ~Storage() {}
+        T items[N];
+        T *heap;
+    } storage;
+    uint32_t count = 0;
+    uint32_t capacity = N; /* Elements live in storage.items while this is N */
+
+    [[nodiscard]] bool isInline() const { return capacity == N; }
+
+    void grow(size_t minimum) {
+        size_t newCapacity = capacity * 2;
+        if (newCapacity < minimum) newCapacity = minimum;
+        T *items = static_cast<T *>(::operator new(newCapacity * sizeof(T)));
+        for (uint32_t i = 0; i < count; ++i) {
+            new(items + i) T(std::move(data()[i]));
+            data()[i].~T();
+        }
+        if (!isInline()) ::operator delete(storage.heap);
+        storage.heap = items;
+        capacity = static_cast<uint32_t>(newCapacity);
+    }
+
+    void takeFrom(SmallVector &&other) noexcept {
+        if (other.isInline()) {
+            for (uint32_t i = 0; i < other.count; ++i) {
+                new(storage.items + i) T(std::move(other.storage.items[i]));
+                other.storage.items[i].~T();
+            }
+        } else {
+            storage.heap = other.storage.heap;
+            capacity = other.capacity;
+            other.capacity = N;
+        }
+        count = other.count;
+        other.count = 0;
+    }
+
+    void release() {
+        clear();
+        if (!isInline()) ::operator delete(storage.heap);
+        capacity = N;
+    }
+
+public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+    using reverse_iterator = std::reverse_iterator<T *>;
+    using const_reverse_iterator = std::reverse_iterator<const T *>;
+
+    SmallVector() = default;
+
+    SmallVector(const SmallVector &other) { assign(other.begin(), other.end()); }
+
+    SmallVector(SmallVector &&other) noexcept { takeFrom(std::move(other)); }
+
+    ~SmallVector() { release(); }
+
+    SmallVector &operator=(const SmallVector &other) {
+        if (this != &other) assign(other.begin(), other.end());
+        return *this;
+    }
+
+    SmallVector &operator=(SmallVector &&other) noexcept {
+        if (this != &other) {
+            release();
+            takeFrom(std::move(other));
+        }
+        return *this;
+    }
+
+    template<typename Iterator>
+    void assign(Iterator first, Iterator last) {
+        clear();
+        reserve(static_cast<size_t>(std::distance(first, last)));
+        for (; first != last; ++first) new(data() + count++) T(*first);
+    }
+
+    void reserve(size_t size) {
+        if (size > capacity) grow(size);
+    }
+
+    void push_back(const T &value) {
+        T copy(value); /* value may be an element that growing moves */
+        push_back(std::move(copy));
+    }
+
+    void push_back(T &&value) {
+        if (count == capacity) grow(count + 1);
+        new(data() + count++) T(std::move(value));
+    }
+
+    void clear() {
+        for (uint32_t i = 0; i < count; ++i) data()[i].~T();
+        count = 0;
+    }
+
+    [[nodiscard]] T *data() { return isInline() ? storage.items : storage.heap; }
+    [[nodiscard]] const T *data() const { return isInline() ? storage.items : storage.heap; }
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+
+    T &operator[](size_t index) { return data()[index]; }
+    const T &operator[](size_t index) const { return data()[index]; }
+    T &back() { return data()[count - 1]; }
+    const T &back() const { return data()[count - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + count; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + count; }
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    bool operator==(const SmallVector &other) const {
+        if (count != other.count) return false;
+        for (uint32_t i = 0; i < count; ++i)
+            if (!(data()[i] == other.data()[i])) return false;
+        return true;
+    }
+};
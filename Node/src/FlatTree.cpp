@@ -0,0 +1,64 @@
+//
+// Created by Erhan Türker on 10/16/26.
+//
+
+#include "../inc/FlatTree.hpp"
+
+FlatTree FlatTree::fromNode(const NodePtr &root) {
+    FlatTree tree;
+    if (!root) return tree;
+
+    struct Pending {
+        const Node *source;
+        size_t nextChild;
+    };
+    std::vector<Pending> pending{{root.get(), 0}};
+    std::vector<uint32_t> done; /* Indices of emitted children whose parent is still pending */
+
+    while (!pending.empty()) {
+        Pending &top = pending.back();
+        const Node *source = top.source;
+        if (top.nextChild < source->children.size()) {
+            const Node *child = source->children[top.nextChild++].get();
+            if (child) {
+                pending.push_back({child, 0});
+            } else {
+                done.push_back(null);
+            }
+            continue;
+        }
+        pending.pop_back();
+
+        const size_t childCount = source->children.size();
+        Entry entry{source->number, source->symbol, static_cast<uint32_t>(tree.childIndices.size()),
+                    static_cast<uint32_t>(childCount), source->type, source->op};
+        tree.childIndices.insert(tree.childIndices.end(), done.end() - static_cast<std::ptrdiff_t>(childCount), done.end());
+        done.resize(done.size() - childCount);
+
+        done.push_back(static_cast<uint32_t>(tree.nodes.size()));
+        tree.nodes.push_back(entry);
+    }
+    /* Trees are built once and kept, drop the growth slack */
+    tree.nodes.shrink_to_fit();
+    tree.childIndices.shrink_to_fit();
+    return tree;
+}
+
+NodePtr FlatTree::toNode() const {
+    if (nodes.empty()) return nullptr;
+
+    /* Post-order guarantees every child is built before its parent */
+    std::vector<NodePtr> built(nodes.size());
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        const Entry &entry = nodes[i];
+        auto node = makeNode(entry.type, entry.symbol, entry.number);
+        node->op = entry.op;
+        node->children.reserve(entry.childCount);
+        for (uint32_t c = 0; c < entry.childCount; ++c) {
+            uint32_t childIndex = childIndices[entry.firstChild + c];
+            node->children.push_back(childIndex == null ? nullptr : std::move(built[childIndex]));
+        }
+        built[i] = std::move(node);
+    }
+    return std::move(built.back());
+}
@@ -5,40 +5,86 @@
 #include "../inc/Node.hpp"
 #include "../../Parser/inc/Parser.hpp"
 
-std::shared_ptr<Node> Node::createNode(const Token &token, const Parser& parser) {
+#include <cstring>
+
+/* Header, symbol, value, cached hash and two inline children. Going below this would need Number values and children
+   to share storage, which every node type would then have to tell apart. */
+static_assert(sizeof(Node) <= 56, "Node grew past its size budget");
+
+NodePtr Node::createNode(const Token &token, const Parser& parser) {
     switch (token.type) {
         case Token::Type::Word:
             if (parser.isDefinedFunction(token))
-                return std::make_shared<Node>(Node{Node::Type::Function, token.value});
-            return std::make_shared<Node>(Node{Node::Type::Variable, token.value});
-        case Token::Type::Number: return std::make_unique<Node>(Node{Node::Type::Number, token.value});
+                return makeNode(Node::Type::Function, token.symbol);
+            return makeNode(Node::Type::Variable, token.symbol);
+        case Token::Type::Number: return makeNode(Node::Type::Number, SymbolTable::empty, token.number);
         case Token::Type::Symbol:
             if (token.value[0] == '=')
-                return std::make_shared<Node>(Node{Node::Type::Assignment, token.value});
-            return std::make_shared<Node>(Node{Node::Type::Operand, token.value});
+                return makeNode(Node::Type::Assignment, token.symbol);
+            return makeNode(Node::Type::Operand, token.symbol);
         default: return nullptr;
     }
 }
 
-std::shared_ptr<Node> Node::createNode(const Token &token) {
+NodePtr Node::createNode(const Token &token) {
     switch (token.type) {
         case Token::Type::Word:
-            return std::make_shared<Node>(Node{Node::Type::Variable, token.value});
-        case Token::Type::Number: return std::make_unique<Node>(Node{Node::Type::Number, token.value});
+            return makeNode(Node::Type::Variable, token.symbol);
+        case Token::Type::Number: return makeNode(Node::Type::Number, SymbolTable::empty, token.number);
         case Token::Type::Symbol:
             if (token.value[0] == '=')
-                return std::make_shared<Node>(Node{Node::Type::Assignment, token.value});
-            return std::make_shared<Node>(Node{Node::Type::Operand, token.value});
+                return makeNode(Node::Type::Assignment, token.symbol);
+            return makeNode(Node::Type::Operand, token.symbol);
         default: return nullptr;
     }
 }
 
-std::shared_ptr<Node> Node::createNode(double value) {
-    return std::make_shared<Node>(Node::Type::Number, std::to_string(value));
+NodePtr Node::createNode(double value) {
+    return makeNode(Node::Type::Number, SymbolTable::empty, value);
+}
+
+NodePtr Node::createNegation(NodePtr operand) {
+    auto negation = makeNode(Node::Type::Operand, "-");
+    negation->op = Op::Neg;
+    negation->children.push_back(std::move(operand));
+    return negation;
+}
+
+Node::Op Node::getOp(Type type, std::string_view name) {
+    if (name.empty()) return Op::None;
+    switch (type) {
+        case Type::Operand:
+            switch (name[0]) {
+                case '+': return Op::Add;
+                case '-': return Op::Sub;
+                case '*': return Op::Mul;
+                case '/': return Op::Div;
+                case '^': return Op::Pow;
+                case '!': return Op::Fact;
+                default: return Op::None;
+            }
+        case Type::Function:
+            if (name == "sin") return Op::Sin;
+            if (name == "cos") return Op::Cos;
+            if (name == "tan") return Op::Tan;
+            if (name == "log") return Op::Log;
+            if (name == "ln") return Op::Ln;
+            if (name == "sqrt") return Op::Sqrt;
+            if (name == "abs") return Op::Abs;
+            if (name == "atan2") return Op::Atan2;
+            return Op::None;
+        case Type::Variable:
+            if (name == "pi") return Op::Pi;
+            if (name == "e") return Op::E;
+            return Op::None;
+        default: return Op::None;
+    }
 }
 
-std::shared_ptr<Node> Node::clone() const {
-    auto newNode = std::make_shared<Node>(this->type, this->value);
+NodePtr Node::clone() const {
+    auto newNode = makeNode(this->type, this->symbol, this->number);
+    newNode->op = this->op;
+    newNode->hash = this->hash;
 
     for (const auto& child : this->children) {
         if (child) {
@@ -48,4 +94,66 @@ std::shared_ptr<Node> Node::clone() const {
         }
     }
     return newNode;
-}
\ No newline at end of file
+}
+
+NodePtr Node::withChildren(Children newChildren) const {
+    auto newNode = makeNode(this->type, this->symbol, this->number);
+    newNode->op = this->op;
+    newNode->children = std::move(newChildren);
+    return newNode;
+}
+
+static uint64_t mix(uint64_t seed, uint64_t value) {
+    /* splitmix64 finalizer over the combined value */
+    uint64_t x = seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2));
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t numberBits(double number) {
+    uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    return bits;
+}
+
+uint64_t Node::getHash() const {
+    if (hash) return hash;
+
+    /* Post-order with an explicit stack; a node is finished once all of its children carry a hash */
+    std::vector<const Node *> pending{this};
+    while (!pending.empty()) {
+        const Node *node = pending.back();
+        bool ready = true;
+        for (const auto &child: node->children) {
+            if (child && !child->hash) {
+                pending.push_back(child.get());
+                ready = false;
+            }
+        }
+        if (!ready) continue;
+        pending.pop_back();
+
+        uint64_t combined = mix(static_cast<uint64_t>(node->type), static_cast<uint64_t>(node->op));
+        combined = mix(combined, node->symbol);
+        if (node->type == Type::Number) combined = mix(combined, numberBits(node->number));
+        combined = mix(combined, node->children.size());
+        for (const auto &child: node->children) combined = mix(combined, child ? child->hash : 0);
+        node->hash = combined ? combined : 1;
+    }
+    return hash;
+}
+
+bool Node::equal(const Node *a, const Node *b) {
+    std::vector<std::pair<const Node *, const Node *>> pending{{a, b}};
+    while (!pending.empty()) {
+        auto [x, y] = pending.back();
+        pending.pop_back();
+        if (x == y) continue;
+        if (!x || !y || x->getHash() != y->getHash()) return false;
+        if (x->type != y->type || x->op != y->op || x->symbol != y->symbol || x->children.size() != y->children.size()) return false;
+        if (x->type == Type::Number && numberBits(x->number) != numberBits(y->number)) return false;
+        for (size_t i = 0; i < x->children.size(); ++i) pending.emplace_back(x->children[i].get(), y->children[i].get());
+    }
+    return true;
+}
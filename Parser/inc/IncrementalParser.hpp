@@ -0,0 +1,34 @@
+//
+// Created by Erhan Türker on 10/16/26.
+//
+
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Parser.hpp"
+
+/* Remembers the statements of every notebook cell so that a re-run only lexes and parses the statements that changed. */
+class IncrementalParser {
+    struct Statement {
+        std::string text;
+        std::vector<std::pair<SymbolId, Parser::SymbolState>> symbols; /* Words in the statement as resolved before parsing it */
+        std::vector<std::string> parameters; /* Parameters of the function the statement defines, if any */
+        std::vector<NodePtr> nodes;
+        bool simplified = true; /* Whether the parser simplified the nodes */
+        bool parsed = true; /* False for statements from the failing one on that have no nodes, kept to line up the rest */
+    };
+
+    std::unordered_map<int, std::vector<Statement>> cells;
+    std::string error;
+
+    static bool isStillValid(const Statement &statement, const Parser &parser);
+    static std::vector<std::pair<SymbolId, Parser::SymbolState>> resolveSymbols(const Lexer &lexer, const Parser &parser);
+
+public:
+    std::vector<NodePtr> parse(int cellId, const std::string &input, Parser &parser);
+
+    [[nodiscard]] std::string getError() const;
+};
@@ -0,0 +1,35 @@
+//
+// Created by Erhan Türker on 10/16/26.
+//
+
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../Node/inc/Node.hpp"
+
+/* Bounded LRU cache of parsed and simplified statements, keyed by their token text. */
+class ParseCache {
+public:
+    struct Entry {
+        uint64_t symbolVersion; /* Parser symbol tables the statement was parsed against */
+        NodePtr statement;
+        std::vector<std::string> parameters; /* Parameters of the function the statement defines, if any */
+    };
+
+    explicit ParseCache(size_t capacity = 4096);
+
+    /* Returns nullptr unless the statement was cached against the same symbol tables */
+    [[nodiscard]] const Entry *find(const std::string &key, uint64_t symbolVersion);
+
+    void insert(const std::string &key, Entry entry);
+
+private:
+    size_t capacity;
+    std::list<std::string> order; /* Most recently used first */
+    std::unordered_map<std::string, std::pair<Entry, std::list<std::string>::iterator>> entries;
+};
@@ -3,52 +3,115 @@
 //
 
 #pragma once
-#include <unordered_set>
-#include <unordered_map>
+#include <optional>
+#include <thread>
 #include <vector>
 
 #include "../../Lexer/inc/Lexer.hpp"
 #include "../../Node/inc/Node.hpp"
+#include "ParseCache.hpp"
+
+struct StatementError {
+    size_t statementIndex; /* Number of statements parsed successfully before the failing one */
+    std::string message;
+};
 
 class Parser {
-    std::shared_ptr<Node> parseExpression(Lexer &lexer, int min_bp);
-    std::shared_ptr<Node> parseLhs(Lexer &lexer, Token& token);
-    std::shared_ptr<Node> parseRhs(Lexer &lexer, std::shared_ptr<Node>& lhs, const Token& token, int min_bp);
+    struct Frame;
+    /* Pratt parser driven by an explicit stack of frames, so nesting depth is bounded by memory instead of the call stack */
+    NodePtr parseExpression(Lexer &lexer, int min_bp);
+    void stepExpression(std::vector<Frame> &stack, NodePtr &result);
+    void stepParentheses(std::vector<Frame> &stack, NodePtr &result);
+    void stepFunction(std::vector<Frame> &stack, NodePtr &result);
+    void stepPrefixToken(std::vector<Frame> &stack, NodePtr &result);
+    void stepDerivative(std::vector<Frame> &stack, NodePtr &result);
+    NodePtr parseOperator(Lexer &lexer, const Token &token, bool& outToken);
+
+    NodePtr parseStatement(Lexer &lexer);
+
+    /* A symbol added to the tables by a statement */
+    struct SymbolDefinition {
+        Node::Type type; /* Assignment or FunctionAssignment */
+        SymbolId name;
+        bool operator==(const SymbolDefinition &) const = default;
+    };
 
-    std::shared_ptr<Node> parseParentheses(Lexer &lexer, const Token &token);
-    std::shared_ptr<Node> parseFunction(Lexer &lexer, const Token &token);
-    std::shared_ptr<Node> parsePrefixToken(Lexer &lexer, const Token &token);
-    std::shared_ptr<Node> parseOperator(Lexer &lexer, const Token &token, bool& outToken);
-    std::shared_ptr<Node> parseDerivative(Lexer &lexer, const Token &token);
+    struct ParsedStatement {
+        NodePtr node; /* nullptr if the statement failed */
+        std::string error;
+        std::optional<SymbolDefinition> defined; /* Kept even if the statement failed after defining it */
+        std::vector<std::string> parameters;
+    };
 
-    std::shared_ptr<Node> parseStatement(Lexer &lexer);
+    static constexpr size_t minParallelTokens = 16 * 1024;
+    static constexpr size_t minParallelChunkStatements = 64;
+    /* Parses the leading statements whose parentheses close on worker threads, leaving the lexer after them.
+       Returns false if one of them failed without recover, with the statements cleared as the sequential loop does. */
+    bool parseParallel(Lexer &lexer, bool recover, unsigned threadCount, std::vector<NodePtr > &statements);
+    ParsedStatement parseTopLevelStatement(Lexer &lexer);
+    /* Adds the symbol the statement would define if it parsed, and returns it if it was new */
+    std::optional<SymbolDefinition> predictDefinition(const Lexer &lexer);
+    void declare(const SymbolDefinition &definition, const std::vector<std::string> &parameters);
+    static int getStatementLength(const Lexer &lexer, bool &isBalanced);
+    static std::string getStatementKey(const Lexer &lexer, int length);
     [[nodiscard]] bool isFunctionDefinition(const Lexer &lexer) const;
     [[nodiscard]] bool isFunctionExpression(const Lexer &lexer) const;
-    static std::pair<std::string, std::vector<std::string>> parseFunctionDefinition(Lexer &lexer);
-    [[nodiscard]] int getNextComma(const Lexer& lexer) const;
-    bool areAllVariablesDefined(const std::shared_ptr<Node> &node, std::string &undefinedVariable, const std::vector<std::string>& parameters = {});
+    static std::pair<SymbolId, std::vector<std::string>> parseFunctionDefinition(Lexer &lexer);
+    bool areAllVariablesDefined(const NodePtr &node, std::string &undefinedVariable, const std::vector<std::string>& parameters = {});
 
     std::string error;
     int parenthesesLevel = 0;
+    uint64_t symbolVersion = 0; /* Bumped whenever a variable or function is added */
+    ParseCache statementCache;
+    ParseCache rawStatementCache; /* Statements parsed with simplification disabled */
+    bool simplifyStatements = true;
+    std::vector<StatementError> statementErrors;
     bool isParsingFunctionCall = false;
 
-    std::unordered_set<std::string> variables = {};
-    static inline const std::unordered_set<std::string> preDefinedVariables = {"e", "pi"};
+    using SymbolSet = SymbolMap<bool>; /* Only the keys are used */
+    using FunctionMap = SymbolMap<std::vector<std::string>>;
 
-    std::unordered_map<std::string, std::vector<std::string>> functions;
-    static inline const std::unordered_map<std::string, std::vector<std::string>> preDefinedFunctions = {
+    SymbolSet variables = {};
+    static inline const SymbolSet preDefinedVariables = {{"e", true}, {"pi", true}};
+
+    FunctionMap functions;
+    static inline const FunctionMap preDefinedFunctions = {
         {"sin", {"0-x"}}, {"cos", {"0-x"}}, {"tan", {"0-x"}},
         {"log", {"0-x"}}, {"ln", {"0-x"}}, {"sqrt", {"0-x"}},
         {"abs", {"0-x"}}, {"atan2", {"0-x", "1-y"}}
     };
 
 public:
+    struct SymbolState {
+        bool isVariable;
+        int argCount; /* -1 if the name is not a function */
+        bool operator==(const SymbolState &) const = default;
+    };
+
     [[nodiscard]] bool isDefinedFunction(const Token &token) const;
 
-    std::vector<std::shared_ptr<Node> > parse(Lexer &lexer);
+    /* How the parser would currently treat the name, parsing depends on nothing else */
+    [[nodiscard]] SymbolState resolveSymbol(SymbolId name) const;
+
+    [[nodiscard]] std::vector<std::string> getFunctionParameters(SymbolId name) const;
+
+    /* Registers the symbols defined by a statement that was parsed earlier, as parsing it again would */
+    void declare(const NodePtr &statement, const std::vector<std::string> &parameters);
+
+    /* With recover set a statement with a syntax error is skipped instead of ending the parse, see getStatementErrors().
+       Large inputs are parsed on up to threadCount threads with the same results. */
+    std::vector<NodePtr > parse(Lexer &lexer, bool recover = false, unsigned threadCount = std::thread::hardware_concurrency());
+
+    /* When disabled, parse returns statements as written and leaves simplification to the caller */
+    void setSimplify(bool enabled);
+
+    [[nodiscard]] bool isSimplifying() const;
 
     std::string getError();
 
+    /* Errors of the statements skipped by the last parse in recovery mode, in input order */
+    [[nodiscard]] const std::vector<StatementError> &getStatementErrors() const;
+
     void clearError();
 
 };
@@ -0,0 +1,100 @@
+//
+// Created by Erhan Türker on 10/16/26.
+//
+
+#include "../inc/IncrementalParser.hpp"
+
+#include <optional>
+#include <sstream>
+
+#include "../../Lexer/inc/StatementReader.hpp"
+
+bool IncrementalParser::isStillValid(const Statement &statement, const Parser &parser) {
+    if (!statement.parsed || statement.simplified != parser.isSimplifying()) return false;
+    for (const auto &[name, state]: statement.symbols) {
+        if (!(parser.resolveSymbol(name) == state)) return false;
+    }
+    return true;
+}
+
+std::vector<std::pair<SymbolId, Parser::SymbolState>> IncrementalParser::resolveSymbols(const Lexer &lexer, const Parser &parser) {
+    std::vector<std::pair<SymbolId, Parser::SymbolState>> symbols;
+    for (int i = 0; lexer.peek(i).type != Token::Type::Eof; ++i) {
+        const Token &token = lexer.peek(i);
+        if (token.type == Token::Type::Word)
+            symbols.emplace_back(token.symbol, parser.resolveSymbol(token.symbol));
+    }
+    return symbols;
+}
+
+std::vector<NodePtr> IncrementalParser::parse(int cellId, const std::string &input, Parser &parser) {
+    error.clear();
+    std::vector<Statement> &previous = cells[cellId];
+
+    /* Splitting only counts parentheses, nothing is lexed yet */
+    std::vector<std::pair<std::string, int>> texts;
+    std::istringstream stream(input);
+    StatementReader reader(stream);
+    std::string text;
+    int firstLine = 1;
+    while (reader.next(text, firstLine)) texts.emplace_back(text, firstLine);
+
+    /* Statements before and after the edited region are candidates for reuse */
+    size_t prefix = 0;
+    while (prefix < texts.size() && prefix < previous.size() && texts[prefix].first == previous[prefix].text) prefix++;
+    size_t suffix = 0;
+    while (suffix < texts.size() - prefix && suffix < previous.size() - prefix
+           && texts[texts.size() - 1 - suffix].first == previous[previous.size() - 1 - suffix].text) suffix++;
+
+    std::vector<Statement *> candidates(texts.size(), nullptr);
+    for (size_t i = 0; i < prefix; ++i) candidates[i] = &previous[i];
+    for (size_t i = 0; i < suffix; ++i) candidates[texts.size() - 1 - i] = &previous[previous.size() - 1 - i];
+
+    /* Edited statements are lexed first so a lexer error is reported before any parser error, as in a full run */
+    std::vector<std::optional<Lexer>> lexers(texts.size());
+    for (size_t i = 0; i < texts.size(); ++i) {
+        if (candidates[i]) continue;
+        lexers[i].emplace(texts[i].first, texts[i].second);
+        if (!lexers[i]->getError().empty()) {
+            error = lexers[i]->getError();
+            return {};
+        }
+    }
+
+    std::vector<Statement> current;
+    std::vector<NodePtr> statements;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        if (candidates[i] && isStillValid(*candidates[i], parser)) {
+            current.push_back(std::move(*candidates[i]));
+            for (const auto &node: current.back().nodes) parser.declare(node, current.back().parameters);
+        } else {
+            if (!lexers[i]) lexers[i].emplace(texts[i].first, texts[i].second);
+            Statement statement{texts[i].first, resolveSymbols(*lexers[i], parser), {}, {}, parser.isSimplifying()};
+            statement.nodes = parser.parse(*lexers[i]);
+            if (!parser.getError().empty()) {
+                error = parser.getError();
+                parser.clearError();
+                /* Statements after the failing one keep what they had, so the next run can still reuse the suffix */
+                for (size_t j = i; j < texts.size(); ++j) {
+                    if (j > i && candidates[j]) current.push_back(std::move(*candidates[j]));
+                    else current.push_back(Statement{texts[j].first, {}, {}, {}, parser.isSimplifying(), false});
+                }
+                previous = std::move(current);
+                return {};
+            }
+            for (const auto &node: statement.nodes) {
+                if (node->type == Node::Type::FunctionAssignment)
+                    statement.parameters = parser.getFunctionParameters(node->symbol);
+            }
+            current.push_back(std::move(statement));
+        }
+        statements.insert(statements.end(), current.back().nodes.begin(), current.back().nodes.end());
+    }
+
+    previous = std::move(current);
+    return statements;
+}
+
+std::string IncrementalParser::getError() const {
+    return error;
+}
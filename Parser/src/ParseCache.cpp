@@ -0,0 +1,30 @@
+//
+// Created by Erhan Türker on 10/16/26.
+//
+
+#include "../inc/ParseCache.hpp"
+
+ParseCache::ParseCache(size_t capacity) : capacity(capacity) {
+}
+
+const ParseCache::Entry *ParseCache::find(const std::string &key, uint64_t symbolVersion) {
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.first.symbolVersion != symbolVersion) return nullptr;
+    order.splice(order.begin(), order, it->second.second);
+    return &it->second.first;
+}
+
+void ParseCache::insert(const std::string &key, Entry entry) {
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        it->second.first = std::move(entry);
+        order.splice(order.begin(), order, it->second.second);
+        return;
+    }
+    if (entries.size() >= capacity) {
+        entries.erase(order.back());
+        order.pop_back();
+    }
+    order.push_front(key);
+    entries.emplace(key, std::make_pair(std::move(entry), order.begin()));
+}
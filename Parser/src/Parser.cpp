@@ -5,23 +5,15 @@
 #include "../inc/Parser.hpp"
 
 #include <algorithm>
+#include <barrier>
+#include <functional>
 #include <ranges>
-#include <unordered_set>
+#include <unordered_map>
 
 #include "../../Simplifier/inc/Simplifier.hpp"
 #include "../../Util/inc/ASTUtil.hpp"
 #include "../inc/ParserErrors.hpp"
 
-template <typename K, typename V>
-static bool contains(const std::unordered_map<K, V>& map, const K& key) {
-    return map.find(key) != map.end();
-}
-
-template <typename K, typename V>
-static bool contains(const std::unordered_set<K, V>& map, const K& key) {
-    return map.find(key) != map.end();
-}
-
 std::pair<int, int> getBindingPower(const Token &token, bool isPrefix = false) {
     if (token.value.empty()) return std::make_pair(-1, -1);
     if (isPrefix) {
@@ -48,41 +40,357 @@ std::pair<int, int> getBindingPower(const Token &token, bool isPrefix = false) {
     return std::make_pair(-1, -1);
 }
 
-std::vector<std::shared_ptr<Node> > Parser::parse(Lexer &lexer) {
-    std::vector<std::shared_ptr<Node> > statements;
+std::vector<NodePtr > Parser::parse(Lexer &lexer, bool recover, unsigned threadCount) {
+    std::vector<NodePtr > statements;
     clearError();
+    statementErrors.clear();
     parenthesesLevel = 0;
 
+    if (threadCount > 1 && lexer.getRemainingTokenCount() >= minParallelTokens) {
+        if (!parseParallel(lexer, recover, threadCount, statements)) return statements;
+    }
+
     while (lexer.peek().type != Token::Type::Eof) {
         while (Token::isNewline(lexer.peek())) {
             lexer.skip();
         }
         if (lexer.peek().type == Token::Type::Eof) break;
 
-        auto statement_node = Simplifier::simplify(parseStatement(lexer));
+        bool isBalanced = true;
+        const int length = getStatementLength(lexer, isBalanced);
+        const std::string key = getStatementKey(lexer, length);
+        ParseCache &cache = simplifyStatements ? statementCache : rawStatementCache;
+        if (const ParseCache::Entry *cached = cache.find(key, symbolVersion)) {
+            lexer.skip(length);
+            declare(cached->statement, cached->parameters);
+            statements.push_back(cached->statement);
+            continue;
+        }
+
+        const uint64_t version = symbolVersion;
+        const Lexer start = lexer;
+        const Token *terminator = &lexer.peek(length);
+        auto statement_node = parseStatement(lexer);
+        if (simplifyStatements) statement_node = Simplifier::simplify(statement_node);
+        if (statement_node) {
+            const Token &next = lexer.peek();
+            if (next.type != Token::Type::Eof && !Token::isNewline(next)) {
+                error = ParserError::UnexpectedToken(lexer);
+                statement_node = nullptr;
+            }
+        }
         if (!statement_node) {
-            statements.clear();
-            return statements;
+            if (!recover) {
+                statements.clear();
+                return statements;
+            }
+            if (!error.empty()) statementErrors.push_back({statements.size(), error});
+            clearError();
+            parenthesesLevel = 0;
+            /* A statement whose parentheses never close would run to the end, only its first line is dropped then */
+            lexer = start;
+            if (isBalanced) {
+                lexer.skip(length);
+            } else {
+                while (lexer.peek().type != Token::Type::Eof && !Token::isNewline(lexer.peek())) lexer.skip();
+            }
+            continue;
+        }
+        statements.push_back(statement_node);
+
+        /* Only cache when the parser stopped exactly where the token scan said the statement ends */
+        if (&lexer.peek() == terminator) {
+            std::vector<std::string> parameters;
+            if (statement_node->type == Node::Type::FunctionAssignment)
+                parameters = getFunctionParameters(statement_node->symbol);
+            cache.insert(key, {version, std::move(statement_node), std::move(parameters)});
+        }
+    }
+    return statements;
+}
+
+namespace {
+/* Threads kept for every round of a parallel parse. A round runs the task once per thread and once on the caller. */
+class WorkerThreads {
+public:
+    explicit WorkerThreads(size_t count)
+        : started(static_cast<std::ptrdiff_t>(count + 1)), finished(static_cast<std::ptrdiff_t>(count + 1)) {
+        for (size_t i = 0; i < count; ++i) threads.emplace_back([this, i] { work(i + 1); });
+    }
+
+    ~WorkerThreads() {
+        stopping = true;
+        started.arrive_and_wait();
+        for (auto &thread: threads) thread.join();
+    }
+
+    /* The caller runs task(0), thread i runs task(i + 1); returns when all of them are done */
+    void run(const std::function<void(size_t)> &task) {
+        current = &task;
+        started.arrive_and_wait();
+        task(0);
+        finished.arrive_and_wait();
+    }
+
+private:
+    void work(size_t index) {
+        while (true) {
+            started.arrive_and_wait();
+            if (stopping) return;
+            (*current)(index);
+            finished.arrive_and_wait();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::barrier<> started;
+    std::barrier<> finished;
+    const std::function<void(size_t)> *current = nullptr;
+    bool stopping = false;
+};
+}
+
+bool Parser::parseParallel(Lexer &lexer, bool recover, unsigned threadCount, std::vector<NodePtr > &statements) {
+    /* A statement whose parentheses never close runs to the end and is left to the sequential loop, like everything after it.
+       The others are kept as token spans and only get a lexer of their own when they are parsed. */
+    struct Span {
+        size_t offset; /* Tokens between the start of the input and the statement */
+        int length;    /* Including the newline, so the statement ends the way it does in the full token stream */
+    };
+    const Lexer start = lexer;
+    std::vector<Span> spans;
+    std::vector<std::string> keys; /* Keyed like the sequential loop, so both paths share the cache */
+    while (true) {
+        while (Token::isNewline(lexer.peek())) lexer.skip();
+        if (lexer.peek().type == Token::Type::Eof) break;
+        bool isBalanced = true;
+        const int length = getStatementLength(lexer, isBalanced);
+        if (!isBalanced) break;
+        keys.push_back(getStatementKey(lexer, length));
+        spans.push_back({start.getRemainingTokenCount() - lexer.getRemainingTokenCount(),
+                         Token::isNewline(lexer.peek(length)) ? length + 1 : length});
+        lexer.skip(length);
+    }
+    auto getStatementLexer = [&](size_t i) {
+        Lexer statementLexer = start;
+        statementLexer.skip(static_cast<int>(spans[i].offset));
+        return statementLexer.getSubLexer(spans[i].length);
+    };
+
+    ParseCache &cache = simplifyStatements ? statementCache : rawStatementCache;
+    const size_t count = spans.size();
+    WorkerThreads threads(std::clamp<size_t>(count / minParallelChunkStatements, 1, threadCount) - 1);
+    size_t next = 0;
+    while (next < count) {
+        const size_t chunkCount = std::clamp<size_t>((count - next) / minParallelChunkStatements, 1, threadCount);
+        std::vector<size_t> boundaries;
+        for (size_t i = 0; i <= chunkCount; ++i) boundaries.push_back(next + i * (count - next) / chunkCount);
+
+        /* Every worker starts from the tables the statements before its chunk are predicted to leave */
+        Parser predictor;
+        predictor.variables = variables;
+        predictor.functions = functions;
+        std::vector<Parser> workers(chunkCount);
+        std::vector<std::optional<SymbolDefinition>> predicted(count - next);
+        std::vector<uint64_t> versions(count - next); /* Predicted symbolVersion before each statement */
+        uint64_t version = symbolVersion;
+        Lexer statementStart = start; /* Balanced statements can be looked at in the full token stream */
+        size_t offset = 0;
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            workers[chunk].variables = predictor.variables;
+            workers[chunk].functions = predictor.functions;
+            workers[chunk].simplifyStatements = simplifyStatements;
+            for (size_t i = boundaries[chunk]; i < boundaries[chunk + 1]; ++i) {
+                versions[i - next] = version;
+                statementStart.skip(static_cast<int>(spans[i].offset - offset));
+                offset = spans[i].offset;
+                predicted[i - next] = predictor.predictDefinition(statementStart);
+                if (predicted[i - next]) version++;
+            }
+        }
+
+        /* A statement that defines nothing leaves the tables as they are. If the same text was parsed against the
+           same tables it is taken from the cache or from its first occurrence in the round instead of parsed again. */
+        std::vector<NodePtr > cached(count - next);
+        std::vector<size_t> firstOccurrence(count - next);
+        std::unordered_map<std::string_view, size_t> latest; /* Last parsed occurrence of every key */
+        for (size_t i = next; i < count; ++i) {
+            firstOccurrence[i - next] = i;
+            if (predicted[i - next]) continue;
+            if (const ParseCache::Entry *entry = cache.find(keys[i], versions[i - next])) {
+                cached[i - next] = entry->statement;
+                continue;
+            }
+            auto [it, inserted] = latest.emplace(keys[i], i);
+            if (!inserted && versions[it->second - next] == versions[i - next]) {
+                firstOccurrence[i - next] = it->second;
+            } else {
+                it->second = i;
+            }
+        }
+        auto isRepeat = [&](size_t i) { return cached[i - next] || firstOccurrence[i - next] != i; };
+        std::vector<size_t> busyChunks; /* Chunks with at least one statement to parse */
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            for (size_t i = boundaries[chunk]; i < boundaries[chunk + 1]; ++i) {
+                if (isRepeat(i)) continue;
+                busyChunks.push_back(chunk);
+                break;
+            }
+        }
+
+        std::vector<ParsedStatement> parsed(count - next);
+        std::vector<uint64_t> parsedVersions(count - next); /* symbolVersion each parsed statement was taken at */
+        auto parseChunk = [&](size_t chunk) {
+            for (size_t i = boundaries[chunk]; i < boundaries[chunk + 1]; ++i) {
+                if (isRepeat(i)) continue;
+                Lexer statementLexer = getStatementLexer(i);
+                parsed[i - next] = workers[chunk].parseTopLevelStatement(statementLexer);
+            }
+        };
+        threads.run([&](size_t busy) {
+            if (busy < busyChunks.size()) parseChunk(busyChunks[busy]);
+        });
+
+        /* Results are taken in order; after a wrong prediction only the rest of that chunk was parsed against the right tables */
+        size_t validUntil = count;
+        size_t chunk = 0;
+        for (size_t i = next; i < validUntil; ++i) {
+            while (i >= boundaries[chunk + 1]) chunk++;
+            const uint64_t statementVersion = parsedVersions[i - next] = symbolVersion;
+            bool parsedHere = false;
+            if (isRepeat(i)) {
+                /* With the tables it was predicted for, a repeat defines nothing and there is nothing to declare */
+                const size_t first = firstOccurrence[i - next];
+                const NodePtr &node = cached[i - next] ? cached[i - next] : parsed[first - next].node;
+                const uint64_t expectedVersion = cached[i - next] ? versions[i - next] : parsedVersions[first - next];
+                if (symbolVersion == expectedVersion && node) {
+                    statements.push_back(node);
+                    continue;
+                }
+                /* Otherwise it is parsed here against the current tables, as the sequential loop would. That includes
+                   repeats of a failed statement, whose error points at their own line. */
+                Lexer statementLexer = getStatementLexer(i);
+                parsed[i - next] = parseTopLevelStatement(statementLexer);
+                parsedHere = true;
+            }
+
+            ParsedStatement &statement = parsed[i - next];
+            if (statement.defined) declare(*statement.defined, statement.parameters);
+            if (statement.defined != predicted[i - next]) {
+                /* The worker skipped a repeat, so it never saw what that one defined */
+                validUntil = std::min(validUntil, parsedHere ? i + 1 : boundaries[chunk + 1]);
+            }
+
+            if (!statement.node) {
+                if (!recover) {
+                    error = statement.error;
+                    statements.clear();
+                    return false;
+                }
+                if (!statement.error.empty()) statementErrors.push_back({statements.size(), statement.error});
+                clearError();
+                continue;
+            }
+            statements.push_back(statement.node);
+
+            std::vector<std::string> parameters;
+            if (statement.node->type == Node::Type::FunctionAssignment)
+                parameters = getFunctionParameters(statement.node->symbol);
+            cache.insert(keys[i], {statementVersion, statement.node, std::move(parameters)});
         }
-        statements.push_back(std::move(statement_node));
+        next = validUntil;
+    }
+    return true;
+}
+
+Parser::ParsedStatement Parser::parseTopLevelStatement(Lexer &lexer) {
+    ParsedStatement parsed;
+    clearError();
+    parenthesesLevel = 0;
 
+    const uint64_t version = symbolVersion;
+    auto statement = parseStatement(lexer);
+    if (statement && symbolVersion != version) {
+        parsed.defined = SymbolDefinition{statement->type, statement->symbol};
+        if (statement->type == Node::Type::FunctionAssignment)
+            parsed.parameters = getFunctionParameters(statement->symbol);
+    }
+    parsed.node = simplifyStatements ? Simplifier::simplify(statement) : statement;
+    if (parsed.node) {
         const Token &next = lexer.peek();
         if (next.type != Token::Type::Eof && !Token::isNewline(next)) {
             error = ParserError::UnexpectedToken(lexer);
-            statements.clear();
-            return statements;
+            parsed.node = nullptr;
         }
     }
-    return statements;
+    parsed.error = error;
+    return parsed;
+}
+
+std::optional<Parser::SymbolDefinition> Parser::predictDefinition(const Lexer &lexer) {
+    if (isFunctionDefinition(lexer)) {
+        if (preDefinedFunctions.contains(lexer.peek().symbol)) return std::nullopt;
+        Lexer definition = lexer;
+        auto [function, parameters] = parseFunctionDefinition(definition);
+        if (!functions.insert(function, std::move(parameters))) return std::nullopt;
+        return SymbolDefinition{Node::Type::FunctionAssignment, function};
+    }
+    const Token &name = lexer.peek();
+    if (name.type != Token::Type::Word || lexer.peek(1).value != "=" || isDefinedFunction(name)
+        || preDefinedVariables.contains(name.symbol)) return std::nullopt;
+    if (!variables.insert(name.symbol, true)) return std::nullopt;
+    return SymbolDefinition{Node::Type::Assignment, name.symbol};
+}
+
+int Parser::getStatementLength(const Lexer &lexer, bool &isBalanced) {
+    int level = 0;
+    int i = 0;
+    for (;; ++i) {
+        const Token &token = lexer.peek(i);
+        if (token.type == Token::Type::Eof) break;
+        if (Token::isNewline(token) && level == 0) break;
+        if (token.type == Token::Type::Symbol && token.value[0] == '(') level++;
+        if (token.type == Token::Type::Symbol && token.value[0] == ')' && level > 0) level--;
+    }
+    isBalanced = level == 0;
+    return i;
+}
+
+std::string Parser::getStatementKey(const Lexer &lexer, int length) {
+    std::string key;
+    for (int i = 0; i < length; ++i) {
+        key += lexer.peek(i).value;
+        key += ' ';
+    }
+    return key;
+}
+
+/* The body with its parameters as Parameter nodes. Nodes are immutable once shared, and the body may share subtrees
+   with the Simplifier's input, so only the path down to a parameter is copied. */
+static NodePtr bindParameters(const NodePtr &node, const std::vector<std::string> &parameters) { // NOLINT(*-no-recursion)
+    if (!node) return nullptr;
+    if (node->type == Node::Type::Variable) {
+        auto it = std::find(parameters.begin(), parameters.end(), node->name());
+        if (it == parameters.end()) return node;
+        auto index = std::distance(parameters.begin(), it);
+        return makeNode(Node::Type::Parameter, std::to_string(index) + "-" + node->name());
+    }
+    Node::Children children;
+    bool changed = false;
+    for (const auto &child: node->children) {
+        children.push_back(bindParameters(child, parameters));
+        changed |= children.back() != child;
+    }
+    return changed ? node->withChildren(std::move(children)) : node;
 }
 
-std::shared_ptr<Node> Parser::parseStatement(Lexer &lexer) {
-    const Token &tmp = lexer.peek(); /* To give correct error if token is undefined variable */
+NodePtr Parser::parseStatement(Lexer &lexer) {
+    const Token tmp = lexer.peek(); /* To give correct error if token is undefined variable */
     bool isFunctionDef = isFunctionDefinition(lexer);
-    std::pair<std::string, std::vector<std::string>> function = {};
+    std::pair<SymbolId, std::vector<std::string>> function = {};
     if (isFunctionDef) {
-        if (contains(preDefinedFunctions, lexer.peek().value)){
-            error = ParserError::AssignmentToPredefinedFunction(lexer.peek().value, lexer.peek());
+        if (preDefinedFunctions.contains(lexer.peek().symbol)){
+            error = ParserError::AssignmentToPredefinedFunction(std::string(lexer.peek().value), lexer.peek());
             return nullptr;
         }
         function =  parseFunctionDefinition(lexer);
@@ -99,11 +407,11 @@ std::shared_ptr<Node> Parser::parseStatement(Lexer &lexer) {
             error = ParserError::InvalidAssignmentTarget(lexer.peek());
             return nullptr;
         }
-        if (contains(preDefinedVariables, lhs->value)) {
-            error = ParserError::AssignmentToLiteralValue(lhs->value, lexer.peek());
+        if (preDefinedVariables.contains(lhs->symbol)) {
+            error = ParserError::AssignmentToLiteralValue(lhs->name(), lexer.peek());
             return nullptr;
         }
-        const Token &as = lexer.next();
+        const Token as = lexer.next();
         auto rhs = parseExpression(lexer, 0);
         if (!rhs) {
             if (error.empty())
@@ -117,9 +425,9 @@ std::shared_ptr<Node> Parser::parseStatement(Lexer &lexer) {
             return nullptr;
         }
 
-        auto assignment_node = std::make_unique<Node>(Node::Type::Assignment, lhs->value);
+        auto assignment_node = makeNode(Node::Type::Assignment, lhs->symbol);
         assignment_node->children.push_back(std::move(rhs));
-        variables.emplace(lhs->value);
+        if (variables.insert(lhs->symbol, true)) symbolVersion++;
         return assignment_node;
     }
     std::string undefinedVar;
@@ -130,69 +438,131 @@ std::shared_ptr<Node> Parser::parseStatement(Lexer &lexer) {
         return nullptr;
     }
     if (isFunctionDef) {
-        auto definitionNode = std::make_unique<Node>(Node::Type::FunctionAssignment, function.first);
-        definitionNode->children.push_back(std::move(lhs));
-        functions.emplace(function);
-        definitionNode->apply([&](Node* node) {
-            if (node->type == Node::Type::Variable) {
-                auto it = std::find(function.second.begin(), function.second.end(), node->value);
-                if (it != function.second.end()) {
-                    node->type = Node::Type::Parameter;
-                    auto index = std::distance(function.second.begin(), it);
-                    node->value = std::to_string(index) + "-" + node->value;
-                }
-            }
-        });
+        auto definitionNode = makeNode(Node::Type::FunctionAssignment, function.first);
+        definitionNode->children.push_back(bindParameters(lhs, function.second));
+        if (functions.insert(function.first, function.second)) symbolVersion++;
         return definitionNode;
     }
     return lhs;
 }
 
-std::shared_ptr<Node> Parser::parseExpression(Lexer &lexer, int min_bp) { // NOLINT(*-no-recursion)
-    Token token(Token::Type::Eof, "", 0, 0, "");
-    std::shared_ptr<Node> lhs = parseLhs(lexer, token);
-    if (!lhs) {
-        return nullptr;
+/* One pending parse step; the stack of these replaces the call stack of the recursive descent */
+struct Parser::Frame {
+    enum class Kind { Expression, Parentheses, Function, PrefixToken, Derivative };
+
+    Kind kind;
+    Lexer *lexer;
+    Token token;           /* Expression: the token its lhs started with, otherwise the token that opened the construct */
+    int minBp = 0;
+    int stage = 0;
+    NodePtr node; /* Expression: lhs so far, otherwise the node being built */
+
+    NodePtr op;   /* Expression: operator waiting for its rhs */
+    Token opToken{Token::Type::Eof, "", 0, 0, nullptr};
+    bool isImplicit = false;
+
+    Token pl{Token::Type::Eof, "", 0, 0, nullptr}; /* Opening parenthesis of a call or derivative */
+    int argCount = 0;
+    int argIndex = 0;
+    int prIndex = 0;
+    std::unique_ptr<Lexer> argLexer;
+    std::unique_ptr<Lexer> argPartLexer;
+
+    Frame(Kind kind, Lexer &lexer, const Token &token, int minBp) : kind(kind), lexer(&lexer), token(token), minBp(minBp) {}
+
+    /* Pushing or popping invalidates references to frames, so these are always the last thing a step does */
+    static void call(std::vector<Frame> &stack, Lexer &lexer, int minBp) {
+        stack.emplace_back(Kind::Expression, lexer, Token(Token::Type::Eof, "", 0, 0, nullptr), minBp);
     }
-    return parseRhs(lexer, lhs, token, min_bp);
-}
 
-std::shared_ptr<Node> Parser::parseLhs(Lexer &lexer, Token &outToken) { // NOLINT(*-no-recursion)
-    const Token &token = lexer.peek();
-    const bool isValid = (token.type == Token::Type::Number)
-                         || (token.type == Token::Type::Word)
-                         || (token.type == Token::Type::Symbol && token.value[0] == '(')
-                         || Token::isTokenPreFix(token)
-                         || (Token::isNewline(token) && parenthesesLevel)
-                         || (token.type == Token::Type::Derivative);
-    if (!isValid) {
-        return nullptr;
+    static void enter(std::vector<Frame> &stack, Kind kind, Lexer &lexer, const Token &token) {
+        stack.emplace_back(kind, lexer, token, 0);
     }
 
-    lexer.skip();
+    static void finish(std::vector<Frame> &stack, NodePtr &result, NodePtr node) {
+        result = std::move(node);
+        stack.pop_back();
+    }
+};
+
+NodePtr Parser::parseExpression(Lexer &lexer, int min_bp) {
+    std::vector<Frame> stack;
+    NodePtr result;
+    Frame::call(stack, lexer, min_bp);
+    while (!stack.empty()) {
+        switch (stack.back().kind) {
+            case Frame::Kind::Expression: stepExpression(stack, result); break;
+            case Frame::Kind::Parentheses: stepParentheses(stack, result); break;
+            case Frame::Kind::Function: stepFunction(stack, result); break;
+            case Frame::Kind::PrefixToken: stepPrefixToken(stack, result); break;
+            case Frame::Kind::Derivative: stepDerivative(stack, result); break;
+        }
+    }
+    return result;
+}
 
-    /* Special case we need to skip the newline */
-    while (Token::isNewline(token)) *const_cast<Token *>(&token) = lexer.next();
+void Parser::stepExpression(std::vector<Frame> &stack, NodePtr &result) {
+    Frame &frame = stack.back();
+    Lexer &lexer = *frame.lexer;
+
+    if (frame.stage == 0) { /* Lhs */
+        Token token = lexer.peek();
+        const bool isValid = (token.type == Token::Type::Number)
+                             || (token.type == Token::Type::Word)
+                             || (token.type == Token::Type::Symbol && token.value[0] == '(')
+                             || Token::isTokenPreFix(token)
+                             || (Token::isNewline(token) && parenthesesLevel)
+                             || (token.type == Token::Type::Derivative);
+        if (!isValid) {
+            Frame::finish(stack, result, nullptr);
+            return;
+        }
 
-    std::shared_ptr<Node> lhs = nullptr;
+        lexer.skip();
 
-    if (token.type == Token::Type::Symbol && token.value[0] == '(') {
-        lhs = parseParentheses(lexer, token);
-    } else if (token.type == Token::Type::Word && isDefinedFunction(token)) {
-        lhs = parseFunction(lexer, token);
-    } else if (Token::isTokenPreFix(token)) {
-        lhs = parsePrefixToken(lexer, token);
-    } else if (token.type == Token::Type::Derivative) {
-        lhs = parseDerivative(lexer, token);
-    } else {
-        lhs = Node::createNode(token, *this);
+        /* Special case we need to skip the newline */
+        while (Token::isNewline(token)) token = lexer.next();
+
+        frame.token = token;
+        frame.stage = 1;
+        if (token.type == Token::Type::Symbol && token.value[0] == '(') {
+            Frame::enter(stack, Frame::Kind::Parentheses, lexer, token);
+            return;
+        }
+        if (token.type == Token::Type::Word && isDefinedFunction(token)) {
+            Frame::enter(stack, Frame::Kind::Function, lexer, token);
+            return;
+        }
+        if (Token::isTokenPreFix(token)) {
+            Frame::enter(stack, Frame::Kind::PrefixToken, lexer, token);
+            return;
+        }
+        if (token.type == Token::Type::Derivative) {
+            Frame::enter(stack, Frame::Kind::Derivative, lexer, token);
+            return;
+        }
+        result = Node::createNode(token, *this);
     }
 
-    outToken = token;
-    return std::move(lhs);
-}
+    if (frame.stage == 1) { /* Lhs is ready */
+        if (!result) {
+            Frame::finish(stack, result, nullptr);
+            return;
+        }
+        frame.node = std::move(result);
+    } else { /* Rhs of frame.op is ready */
+        if (result == nullptr) {
+            if (error.empty())
+                error = ParserError::MissingRhs(frame.opToken, frame.isImplicit);
+            Frame::finish(stack, result, nullptr);
+            return;
+        }
+        frame.op->children.push_back(std::move(frame.node));
+        frame.op->children.push_back(std::move(result));
+        frame.node = std::move(frame.op);
+    }
 
-std::shared_ptr<Node> Parser::parseRhs(Lexer &lexer, std::shared_ptr<Node>& lhs, const Token& token, int min_bp) { // NOLINT(*-no-recursion)
+    const Token &token = frame.token;
     while (true) {
         if (lexer.peek().type == Token::Type::Eof) break;
         if (parenthesesLevel == 0 && Token::isNewline(lexer.peek())) break;
@@ -203,171 +573,225 @@ std::shared_ptr<Node> Parser::parseRhs(Lexer &lexer, std::shared_ptr<Node>& lhs,
         if (lexer.peek().type == Token::Type::Symbol && lexer.peek().value[0] == ')') break;
 
         bool isImplicit = false;
-        std::shared_ptr<Node> op = parseOperator(lexer, token, isImplicit);
-        if (!op) return nullptr;
+        NodePtr op = parseOperator(lexer, token, isImplicit);
+        if (!op) {
+            Frame::finish(stack, result, nullptr);
+            return;
+        }
 
         auto &&[lhs_bp, rhs_bp] = getBindingPower(lexer.peek());
-        if (lhs_bp < min_bp) break;
+        if (lhs_bp < frame.minBp) break;
 
         if (Token::isTokenPostFix(lexer.peek())) {
             lexer.skip();
-            op->children.push_back(std::move(lhs));
-            lhs = std::move(op);
+            op->children.push_back(std::move(frame.node));
+            frame.node = std::move(op);
             if (lexer.peek().type == Token::Type::Word || lexer.peek().type == Token::Type::Number) {
-                Token temp{Token::Type::Symbol, "*", token.line, lexer.peek().pos - 1, token.line_content};
-                lexer.addToken(temp);
+                Token temp{Token::Type::Symbol, "*", token.line, lexer.peek().pos - 1, token.source};
+                lexer.addVirtualToken(temp);
             }
             continue;
         }
 
-        const auto &opToken = lexer.next();
-        auto rhs = parseExpression(lexer, rhs_bp);
-        if (rhs == nullptr) {
-            if (error.empty())
-                error = ParserError::MissingRhs(opToken, isImplicit);
-            return nullptr;
-        }
-        op->children.push_back(std::move(lhs));
-        op->children.push_back(std::move(rhs));
-        lhs = std::move(op);
+        frame.opToken = lexer.next();
+        frame.op = std::move(op);
+        frame.isImplicit = isImplicit;
+        frame.stage = 2;
+        Frame::call(stack, lexer, rhs_bp);
+        return;
     }
-    return std::move(lhs);
+    Frame::finish(stack, result, std::move(frame.node));
 }
 
-std::shared_ptr<Node> Parser::parseParentheses(Lexer &lexer, const Token &token) { // NOLINT(*-no-recursion)
-    parenthesesLevel++;
-    std::shared_ptr<Node> lhs = parseExpression(lexer, 0);
+void Parser::stepParentheses(std::vector<Frame> &stack, NodePtr &result) {
+    Frame &frame = stack.back();
+    Lexer &lexer = *frame.lexer;
+    const Token &token = frame.token;
+
+    if (frame.stage == 0) {
+        parenthesesLevel++;
+        frame.stage = 1;
+        Frame::call(stack, lexer, 0);
+        return;
+    }
+
+    NodePtr lhs = std::move(result);
     const Token &pr = lexer.peek();
     if (pr.type != Token::Type::Symbol || pr.value[0] != ')') {
-        if (!error.empty())
-            return nullptr;
-        if (!lhs)
-            error = ParserError::InvalidStart(lexer);
-        else
-            error = ParserError::MissingParen(lexer, token);
-        return nullptr;
+        if (error.empty()) {
+            if (!lhs)
+                error = ParserError::InvalidStart(lexer);
+            else
+                error = ParserError::MissingParen(lexer, token);
+        }
+        Frame::finish(stack, result, nullptr);
+        return;
     }
     lexer.skip();
     parenthesesLevel--;
     if (!lhs) {
         if (error.empty())
             error = ParserError::EmptyParen(token);
-        return std::move(lhs);
+        Frame::finish(stack, result, nullptr);
+        return;
     }
     if (lexer.peek().type == Token::Type::Number || lexer.peek().type == Token::Type::Word) {
-        Token temp{Token::Type::Symbol, "*", token.line, token.pos, token.line_content};
-        lexer.addToken(temp);
+        Token temp{Token::Type::Symbol, "*", token.line, token.pos, token.source};
+        lexer.addVirtualToken(temp);
     }
-    return std::move(lhs);
+    Frame::finish(stack, result, std::move(lhs));
 }
 
-std::shared_ptr<Node> Parser::parseFunction(Lexer &lexer, const Token &token) { // NOLINT(*-no-recursion)
-    std::shared_ptr<Node> func = Node::createNode(token, *this);
-
-    int argCount = 0;
-    if (contains(preDefinedFunctions, token.value)) {
-        argCount = static_cast<int>(preDefinedFunctions.at(token.value).size());
-    } else if (contains(functions, token.value)) {
-        argCount = static_cast<int>(functions.at(token.value).size());
-    } else {
-        error = ParserError::UnkownFunction(token);
-        return nullptr;
-    }
+void Parser::stepFunction(std::vector<Frame> &stack, NodePtr &result) {
+    enum { Start, NextArgument, ArgumentPart, LastArgument, PrefixArgument };
+    Frame &frame = stack.back();
+    Lexer &lexer = *frame.lexer;
+    const Token &token = frame.token;
+
+    switch (frame.stage) {
+        case Start: {
+            frame.node = Node::createNode(token, *this);
+
+            if (auto parameters = preDefinedFunctions.find(token.symbol)) {
+                frame.argCount = static_cast<int>(parameters->size());
+            } else if ((parameters = functions.find(token.symbol))) {
+                frame.argCount = static_cast<int>(parameters->size());
+            } else {
+                error = ParserError::UnkownFunction(token);
+                Frame::finish(stack, result, nullptr);
+                return;
+            }
 
-    const Token &pl = lexer.peek();
-    if (pl.type == Token::Type::Symbol && pl.value[0] == '(') {  /* Standard form */
-        parenthesesLevel++;
-        lexer.skip();
-        while (lexer.peek().type == Token::Type::Newline) lexer.skip();
-        int prIndex = lexer.getClosingParenthesesIndex();
-        if (prIndex < 0) {
-            return nullptr;
-        }
-        Lexer argLexer = lexer.getSubLexer(prIndex);
-        if (!prIndex) {
-            if (error.empty())
-                error = ParserError::EmptyParen(pl);
-            return nullptr;
-        }
-        lexer.removeToken(prIndex);
-        if (argCount > 1) {
-            for (int i = 1; i < argCount; ++i) {
-                int commaIndex = getNextComma(argLexer);
-                if (commaIndex < 0) {
-                    if (error.empty())
-                        error = ParserError::NotEnoughArguments(token, argCount);
-                    return nullptr;
-                }
-                Lexer argPartLexer = argLexer.getSubLexer(commaIndex);
-                if (argPartLexer.peek().type == Token::Type::Eof) {
+            frame.pl = lexer.peek();
+            if (frame.pl.type != Token::Type::Symbol || frame.pl.value[0] != '(') { /* Prefix like form */
+                if (frame.argCount > 1) {
                     if (error.empty())
-                        error = ParserError::EmptyArgument(argLexer.peek());
+                        error = ParserError::MultiArgumentCalledWoParentheses(token, frame.argCount);
+                    Frame::finish(stack, result, nullptr);
+                    return;
                 }
-                argLexer.skip(commaIndex + 1);
-                std::shared_ptr<Node> argPart = parseExpression(argPartLexer, 0);
-                if (argPart == nullptr) {
-                    return nullptr; /* Arg is already invalid use previous error */
-                }
-                func->children.push_back(std::move(argPart));
+                auto&& [lhs_bp, rhs_bp] = getBindingPower(token);
+                frame.stage = PrefixArgument;
+                Frame::call(stack, lexer, rhs_bp);
+                return;
             }
+
+            /* Standard form */
+            parenthesesLevel++;
+            lexer.skip();
+            while (lexer.peek().type == Token::Type::Newline) lexer.skip();
+            frame.prIndex = lexer.getClosingParenthesesIndex();
+            if (frame.prIndex < 0) {
+                Frame::finish(stack, result, nullptr);
+                return;
+            }
+            frame.argLexer = std::make_unique<Lexer>(lexer.getSubLexer(frame.prIndex));
+            if (!frame.prIndex) {
+                if (error.empty())
+                    error = ParserError::EmptyParen(frame.pl);
+                Frame::finish(stack, result, nullptr);
+                return;
+            }
+            frame.argIndex = 1;
+            break;
         }
-        std::shared_ptr<Node> arg = parseExpression(argLexer, 0);
-        if (arg == nullptr) {
-            error = ParserError::TooManyArguments(token, argCount); /*Overwrite the unexpected token error */
-            return nullptr; /* Arg is already invalid use previous error */
-        }
-        func->children.push_back(std::move(arg));
-        lexer.skip(prIndex);
-        if (lexer.peek().type == Token::Type::Number || lexer.peek().type == Token::Type::Word) {
-            Token temp{Token::Type::Symbol, "*", token.line, token.pos, token.line_content};
-            lexer.addToken(temp);
-        }
-        parenthesesLevel--;
-    }
-    else { /* Prefix like form */
-        if (argCount>1) {
+        case ArgumentPart:
+            if (result == nullptr) {
+                Frame::finish(stack, result, nullptr); /* Arg is already invalid use previous error */
+                return;
+            }
+            frame.node->children.push_back(std::move(result));
+            frame.argIndex++;
+            break;
+        case LastArgument:
+            if (result == nullptr) {
+                error = ParserError::TooManyArguments(token, frame.argCount); /*Overwrite the unexpected token error */
+                Frame::finish(stack, result, nullptr);
+                return;
+            }
+            frame.node->children.push_back(std::move(result));
+            lexer.skip(frame.prIndex + 1); /* Arguments and the closing parenthesis */
+            if (lexer.peek().type == Token::Type::Number || lexer.peek().type == Token::Type::Word) {
+                Token temp{Token::Type::Symbol, "*", token.line, token.pos, token.source};
+                lexer.addVirtualToken(temp);
+            }
+            parenthesesLevel--;
+            Frame::finish(stack, result, std::move(frame.node));
+            return;
+        case PrefixArgument:
+            if (result == nullptr) {
+                if (error.empty())
+                    error = ParserError::NoArg(lexer, token);
+                Frame::finish(stack, result, nullptr);
+                return;
+            }
+            frame.node->children.push_back(std::move(result));
+            Frame::finish(stack, result, std::move(frame.node));
+            return;
+        default:
+            break;
+    }
+
+    /* Every argument but the last one ends at a comma */
+    Lexer &argLexer = *frame.argLexer;
+    if (frame.argIndex < frame.argCount) {
+        int commaIndex = argLexer.getNextCommaIndex();
+        if (commaIndex < 0) {
             if (error.empty())
-                error = ParserError::MultiArgumentCalledWoParentheses(token, argCount);
-            return nullptr;
+                error = ParserError::NotEnoughArguments(token, frame.argCount);
+            Frame::finish(stack, result, nullptr);
+            return;
         }
-        auto&& [lhs_bp, rhs_bp] = getBindingPower(token);
-        std::shared_ptr<Node> expr = parseExpression(lexer, rhs_bp);
-        if (expr == nullptr) {
+        frame.argPartLexer = std::make_unique<Lexer>(argLexer.getSubLexer(commaIndex));
+        if (frame.argPartLexer->peek().type == Token::Type::Eof) {
             if (error.empty())
-                error = ParserError::NoArg(lexer, token);
-            return nullptr;
+                error = ParserError::EmptyArgument(argLexer.peek());
         }
-        func->children.push_back(std::move(expr));
+        argLexer.skip(commaIndex + 1);
+        frame.stage = ArgumentPart;
+        Frame::call(stack, *frame.argPartLexer, 0);
+        return;
     }
-
-    return std::move(func);
+    frame.stage = LastArgument;
+    Frame::call(stack, argLexer, 0);
 }
 
-std::shared_ptr<Node> Parser::parsePrefixToken(Lexer &lexer, const Token &token) { // NOLINT(*-no-recursion)
-    auto&& [lhs_bp, rhs_bp] = getBindingPower(token, true);
-    std::shared_ptr<Node> op = Node::createNode(token, *this);
-    std::shared_ptr<Node> arg = parseExpression(lexer, rhs_bp);
-    if (arg == nullptr) {
-        if (!error.empty())
-            return nullptr;
-        if (lexer.peek().type == Token::Type::Eof) {
-            error = ParserError::MissingOperandForPrefix(token);
-        } else {
-            error = ParserError::InvalidStart(lexer);
+void Parser::stepPrefixToken(std::vector<Frame> &stack, NodePtr &result) {
+    Frame &frame = stack.back();
+    Lexer &lexer = *frame.lexer;
+    const Token &token = frame.token;
+
+    if (frame.stage == 0) {
+        auto&& [lhs_bp, rhs_bp] = getBindingPower(token, true);
+        frame.node = Node::createNode(token, *this);
+        if (frame.node->op == Node::Op::Sub) frame.node->op = Node::Op::Neg;
+        frame.stage = 1;
+        Frame::call(stack, lexer, rhs_bp);
+        return;
+    }
+
+    if (result == nullptr) {
+        if (error.empty()) {
+            if (lexer.peek().type == Token::Type::Eof) {
+                error = ParserError::MissingOperandForPrefix(token);
+            } else {
+                error = ParserError::InvalidStart(lexer);
+            }
         }
-        return nullptr;
+        Frame::finish(stack, result, nullptr);
+        return;
     }
-    op->children.push_back(std::move(arg));
-    return std::move(op);
+    frame.node->children.push_back(std::move(result));
+    Frame::finish(stack, result, std::move(frame.node));
 }
 
-std::shared_ptr<Node> Parser::parseOperator(Lexer &lexer, const Token &token, bool& isImplicit) {
-    std::shared_ptr<Node> op = nullptr;
+NodePtr Parser::parseOperator(Lexer &lexer, const Token &token, bool& isImplicit) {
+    NodePtr op = nullptr;
     if (lexer.peek().type == Token::Type::Symbol) {
         if (lexer.peek().value[0] == '(') {
-            Token temp{Token::Type::Symbol, "*", token.line, lexer.peek().pos - 1, token.line_content};
+            Token temp{Token::Type::Symbol, "*", token.line, lexer.peek().pos - 1, token.source};
             op = Node::createNode(temp, *this);
-            lexer.addToken(temp);
+            lexer.addVirtualToken(temp);
             isImplicit = true;
         } else {
             op = Node::createNode(lexer.peek(), *this);
@@ -376,9 +800,9 @@ std::shared_ptr<Node> Parser::parseOperator(Lexer &lexer, const Token &token, bo
             (token.type == Token::Type::Number && lexer.peek().type == Token::Type::Word)
         ||  (token.type == Token::Type::Word && lexer.peek().type == Token::Type::Word)
         ||  (token.type == Token::Type::Word && lexer.peek().type == Token::Type::Number)) {
-        Token temp{Token::Type::Symbol, "*", token.line, lexer.peek().pos - 1, token.line_content};
+        Token temp{Token::Type::Symbol, "*", token.line, lexer.peek().pos - 1, token.source};
         op = Node::createNode(temp, *this);
-        lexer.addToken(temp);
+        lexer.addVirtualToken(temp);
         isImplicit = true;
     } else {
         if (!error.empty()) {
@@ -392,34 +816,46 @@ std::shared_ptr<Node> Parser::parseOperator(Lexer &lexer, const Token &token, bo
             error = ParserError::MissingOperator(Token(token), lexer.peek());
         return nullptr;
     }
-    return std::move(op);
+    return op;
 }
 
-std::shared_ptr<Node> Parser::parseDerivative(Lexer &lexer, const Token &token) { // NOLINT(*-no-recursion)
-    std::string var = token.value.substr(3);
-    auto derivNode = std::make_shared<Node>(Node::Type::Derivative, var);
+void Parser::stepDerivative(std::vector<Frame> &stack, NodePtr &result) {
+    Frame &frame = stack.back();
+    Lexer &lexer = *frame.lexer;
+    const Token &token = frame.token;
 
-    const Token &pl = lexer.peek();
-    if (pl.type != Token::Type::Symbol || pl.value[0] != '(') {
-        if (error.empty())
-            error = ParserError::NoArg(lexer, token);
-        return nullptr;
-    }
+    if (frame.stage == 0) {
+        std::string var(token.value.substr(3));
+        frame.node = makeNode(Node::Type::Derivative, var);
 
-    parenthesesLevel++;
-    lexer.skip();
+        frame.pl = lexer.peek();
+        if (frame.pl.type != Token::Type::Symbol || frame.pl.value[0] != '(') {
+            if (error.empty())
+                error = ParserError::NoArg(lexer, token);
+            Frame::finish(stack, result, nullptr);
+            return;
+        }
+
+        parenthesesLevel++;
+        lexer.skip();
 
-    std::shared_ptr<Node> expression = parseExpression(lexer, 0);
+        frame.stage = 1;
+        Frame::call(stack, lexer, 0);
+        return;
+    }
+
+    NodePtr expression = std::move(result);
 
     const Token &pr = lexer.peek();
     if (pr.type != Token::Type::Symbol || pr.value[0] != ')') {
-        if (!error.empty())
-            return nullptr;
-        if (!expression)
-            error = ParserError::EmptyParen(pl);
-        else
-            error = ParserError::MissingParen(lexer, pl);
-        return nullptr;
+        if (error.empty()) {
+            if (!expression)
+                error = ParserError::EmptyParen(frame.pl);
+            else
+                error = ParserError::MissingParen(lexer, frame.pl);
+        }
+        Frame::finish(stack, result, nullptr);
+        return;
     }
 
     lexer.skip();
@@ -427,28 +863,29 @@ std::shared_ptr<Node> Parser::parseDerivative(Lexer &lexer, const Token &token)
 
     if (!expression) {
         if (error.empty())
-            error = ParserError::EmptyParen(pl);
-        return nullptr;
+            error = ParserError::EmptyParen(frame.pl);
+        Frame::finish(stack, result, nullptr);
+        return;
     }
 
-    derivNode->children.push_back(std::move(expression));
+    frame.node->children.push_back(std::move(expression));
 
     if (lexer.peek().type == Token::Type::Number || lexer.peek().type == Token::Type::Word) {
-        Token temp{Token::Type::Symbol, "*", token.line, token.pos, token.line_content};
-        lexer.addToken(temp);
+        Token temp{Token::Type::Symbol, "*", token.line, token.pos, token.source};
+        lexer.addVirtualToken(temp);
     }
 
-    return derivNode;
+    Frame::finish(stack, result, std::move(frame.node));
 }
 
-std::pair<std::string, std::vector<std::string>> Parser::parseFunctionDefinition(Lexer &lexer) { // NOLINT(*-no-recursion)
-    std::string functionName = lexer.next().value;
+std::pair<SymbolId, std::vector<std::string>> Parser::parseFunctionDefinition(Lexer &lexer) { // NOLINT(*-no-recursion)
+    const SymbolId functionName = lexer.next().symbol;
     lexer.skip();
     std::vector<std::string> tempVariables;
     while (true) {
-        const auto& token = lexer.next();
+        const Token token = lexer.next();
         if (token.type == Token::Type::Word)
-            tempVariables.push_back(token.value);
+            tempVariables.emplace_back(token.value);
         else if (token.type == Token::Type::Symbol && token.value[0] == '=') break;
     }
     return std::make_pair(functionName, tempVariables);
@@ -456,9 +893,12 @@ std::pair<std::string, std::vector<std::string>> Parser::parseFunctionDefinition
 
 bool Parser::isFunctionDefinition(const Lexer &lexer) const {
     if (lexer.peek().type != Token::Type::Word
-        || contains(variables, lexer.peek().value)
-        || contains(preDefinedVariables, lexer.peek().value)) return false;
+        || variables.contains(lexer.peek().symbol)
+        || preDefinedVariables.contains(lexer.peek().symbol)) return false;
     if (lexer.peek(1).type != Token::Type::Symbol || lexer.peek(1).value[0] != '(') return false;
+    /* Only a '=' after the closing parenthesis makes this a definition, check that before walking the parameters */
+    const int prIndex = lexer.getClosingParenthesesIndex(2);
+    if (prIndex < 0 || lexer.peek(prIndex + 1).type != Token::Type::Symbol || lexer.peek(prIndex + 1).value[0] != '=') return false;
     int i = 2;
     while (true) {
         while (Token::isNewline(lexer.peek(i))) {i++;}
@@ -468,15 +908,16 @@ bool Parser::isFunctionDefinition(const Lexer &lexer) const {
         while (Token::isNewline(lexer.peek(i))) {i++;}
         if (lexer.peek(i++).type != Token::Type::Comma) return false;
     }
-    if (lexer.peek(i).type == Token::Type::Symbol && lexer.peek(i).value[0] == '=') return true;
-    return false;
+    return true;
 }
 
 bool Parser::isFunctionExpression(const Lexer &lexer) const {
     if (lexer.peek().type != Token::Type::Word
-        || contains(variables, lexer.peek().value)
-        || contains(preDefinedVariables, lexer.peek().value)) return false;
+        || variables.contains(lexer.peek().symbol)
+        || preDefinedVariables.contains(lexer.peek().symbol)) return false;
     if (lexer.peek(1).type != Token::Type::Symbol || lexer.peek(1).value[0] != '(') return false;
+    const int prIndex = lexer.getClosingParenthesesIndex(2);
+    if (prIndex < 0 || (lexer.peek(prIndex + 1).type == Token::Type::Symbol && lexer.peek(prIndex + 1).value[0] == '=')) return false;
     int i = 2;
     while (true) {
         while (Token::isNewline(lexer.peek(i))) {i++;}
@@ -486,44 +927,24 @@ bool Parser::isFunctionExpression(const Lexer &lexer) const {
         while (Token::isNewline(lexer.peek(i))) {i++;}
         if (lexer.peek(i++).type != Token::Type::Comma) return false;
     }
-    if (lexer.peek(i).type == Token::Type::Symbol && lexer.peek(i).value[0] == '=') return false;
     return true;
 }
 
 bool Parser::isDefinedFunction(const Token &token) const {
-    return contains(preDefinedFunctions, token.value) || contains(functions, token.value);
-}
-
-int Parser::getNextComma(const Lexer& lexer) const {
-    int skip = 0;
-    for (int i = 0; ;) {
-        if (lexer.peek(i).type == Token::Type::Eof) return -1;
-        if (lexer.peek(i).type == Token::Type::Word) {
-            if (contains(functions, lexer.peek(i).value)) {
-                skip += static_cast<int>(functions.at(lexer.peek(i).value).size()) - 1;
-            } else if (contains(preDefinedFunctions, lexer.peek(i).value)) {
-                skip += static_cast<int>(preDefinedFunctions.at(lexer.peek(i).value).size()) - 1;
-            }
-        }
-        if (lexer.peek(i).type == Token::Type::Comma) {
-            if (skip == 0) return i;
-            skip--;
-        }
-        i++;
-    }
+    return preDefinedFunctions.contains(token.symbol) || functions.contains(token.symbol);
 }
 
-bool Parser::areAllVariablesDefined(const std::shared_ptr<Node> &node, std::string &undefinedVariable, const std::vector<std::string>& parameters) { // NOLINT(*-no-recursion)
+bool Parser::areAllVariablesDefined(const NodePtr &node, std::string &undefinedVariable, const std::vector<std::string>& parameters) { // NOLINT(*-no-recursion)
     if (!node) {
         return true;
     }
 
     if (node->type == Node::Type::Variable) {
-        bool foundInParams = std::find(parameters.begin(), parameters.end(), node->value) != parameters.end();
-        bool foundInSets = contains(variables, node->value) || contains(preDefinedVariables, node->value);
+        bool foundInParams = std::find(parameters.begin(), parameters.end(), node->name()) != parameters.end();
+        bool foundInSets = variables.contains(node->symbol) || preDefinedVariables.contains(node->symbol);
 
         if (!(foundInSets || foundInParams)) {
-            undefinedVariable = node->value;
+            undefinedVariable = node->name();
             return false;
         }
     }
@@ -537,10 +958,49 @@ bool Parser::areAllVariablesDefined(const std::shared_ptr<Node> &node, std::stri
     return true;
 }
 
+Parser::SymbolState Parser::resolveSymbol(SymbolId name) const {
+    SymbolState state{variables.contains(name) || preDefinedVariables.contains(name), -1};
+    if (auto parameters = preDefinedFunctions.find(name)) {
+        state.argCount = static_cast<int>(parameters->size());
+    } else if ((parameters = functions.find(name))) {
+        state.argCount = static_cast<int>(parameters->size());
+    }
+    return state;
+}
+
+std::vector<std::string> Parser::getFunctionParameters(SymbolId name) const {
+    auto parameters = functions.find(name);
+    return parameters ? *parameters : std::vector<std::string>{};
+}
+
+void Parser::declare(const NodePtr &statement, const std::vector<std::string> &parameters) {
+    declare(SymbolDefinition{statement->type, statement->symbol}, parameters);
+}
+
+void Parser::declare(const SymbolDefinition &definition, const std::vector<std::string> &parameters) {
+    if (definition.type == Node::Type::Assignment) {
+        if (variables.insert(definition.name, true)) symbolVersion++;
+    } else if (definition.type == Node::Type::FunctionAssignment) {
+        if (functions.insert(definition.name, parameters)) symbolVersion++;
+    }
+}
+
+void Parser::setSimplify(bool enabled) {
+    simplifyStatements = enabled;
+}
+
+bool Parser::isSimplifying() const {
+    return simplifyStatements;
+}
+
 std::string Parser::getError() {
     return error;
 }
 
+const std::vector<StatementError> &Parser::getStatementErrors() const {
+    return statementErrors;
+}
+
 void Parser::clearError() {
     error.clear();
 }
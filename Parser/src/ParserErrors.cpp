@@ -19,7 +19,7 @@ std::string ParserError::NoArg(const Lexer &lexer, const Token &token) {
     const Token &ofToken = offending_token.type != Token::Type::Eof ? offending_token : token;
 
     oss << "--> at line " << ofToken.line << ":\n";
-    oss << "    " << ofToken.line_content << "\n";
+    oss << "    " << ofToken.getLineContent() << "\n";
     oss << "    " << std::string(ofToken.pos, ' ') << "^-- Here";
 
     return oss.str();
@@ -31,7 +31,7 @@ std::string ParserError::UnexpectedToken(const Lexer &lexer) {
     std::ostringstream oss;
     oss << "Unexpected token '" << offending_token.value << "'\n";
     oss << "--> at line " << offending_token.line << ":\n";
-    oss << "    " << offending_token.line_content << "\n";
+    oss << "    " << offending_token.getLineContent() << "\n";
     oss << "    " << std::string(offending_token.pos, ' ') << "^-- This should not be here";
 
     return oss.str();
@@ -45,7 +45,7 @@ std::string ParserError::InvalidStart(const Lexer &lexer) {
             << offending_token.value << "'.\n";
 
     oss << "--> at line " << offending_token.line << ":\n";
-    oss << "    " << offending_token.line_content << "\n";
+    oss << "    " << offending_token.getLineContent() << "\n";
     oss << "    " << std::string(offending_token.pos, ' ') << "^-- An expression cannot start here";
 
     return oss.str();
@@ -59,13 +59,13 @@ std::string ParserError::MissingParen(const Lexer &lexer, const Token &open_pare
             << open_paren_token.line << ".\n";
 
     oss << "--> at line " << open_paren_token.line << ":\n";
-    oss << "    " << open_paren_token.line_content << "\n";
+    oss << "    " << open_paren_token.getLineContent() << "\n";
     oss << "    " << std::string(open_paren_token.pos, ' ') << "^-- This parenthesis was never closed.\n\n";
 
     if (offending_token.type != Token::Type::Eof && offending_token.type != Token::Type::Newline) {
         oss << "Instead, found '" << offending_token.value << "' here:\n";
         oss << "--> at line " << offending_token.line << ":\n";
-        oss << "    " << offending_token.line_content << "\n";
+        oss << "    " << offending_token.getLineContent() << "\n";
         oss << "    " << std::string(offending_token.pos, ' ') << "^-- Expected ')'";
     } else {
         oss << "Instead, the input ended before the parenthesis was closed.";
@@ -80,7 +80,7 @@ std::string ParserError::MissingOperandForPrefix(const Token &prefix_token) {
             << "' is missing an expression on its right-hand side.\n";
 
     oss << "--> at line " << prefix_token.line << ":\n";
-    oss << "    " << prefix_token.line_content << "\n";
+    oss << "    " << prefix_token.getLineContent() << "\n";
     oss << "    " << std::string(prefix_token.pos, ' ') << "^-- An expression was expected to follow this operator";
 
     return oss.str();
@@ -92,7 +92,7 @@ std::string ParserError::MissingRhs(const Token &operator_token, const bool isIm
             << "' is missing a right-hand side expression.\n";
 
     oss << "--> at line " << operator_token.line << ":\n";
-    oss << "    " << operator_token.line_content << "\n";
+    oss << "    " << operator_token.getLineContent() << "\n";
     oss << "    " << std::string(operator_token.pos, ' ') << "^-- An expression was expected to follow this operator";
 
     return oss.str();
@@ -102,7 +102,7 @@ std::string ParserError::MissingAssignment(const Token &operator_token) {
     std::ostringstream oss;
     oss << "Assignment operator '=' is missing a right-hand side expression.\n";
     oss << "--> at line " << operator_token.line << ":\n";
-    oss << "    " << operator_token.line_content << "\n";
+    oss << "    " << operator_token.getLineContent() << "\n";
     oss << "    " << std::string(operator_token.pos, ' ') << "^-- An expression was expected to follow the assignment.";
 
     return oss.str();
@@ -113,7 +113,7 @@ std::string ParserError::EmptyParen(const Token &open_paren_token) {
     oss << "An expression was expected inside parentheses, but none was found.\n";
 
     oss << "--> at line " << open_paren_token.line << ":\n";
-    oss << "    " << open_paren_token.line_content << "\n";
+    oss << "    " << open_paren_token.getLineContent() << "\n";
     oss << "    " << std::string(open_paren_token.pos, ' ') << "^-- Expected an expression after this parenthesis";
 
     return oss.str();
@@ -125,7 +125,7 @@ std::string ParserError::MissingOperator(const Token &previous_token, const Toke
             << "' and '" << offending_token.value << "'.\n";
 
     oss << "--> at line " << offending_token.line << ":\n";
-    oss << "    " << offending_token.line_content << "\n";
+    oss << "    " << offending_token.getLineContent() << "\n";
     oss << "    " << std::string(offending_token.pos, ' ') << "^-- An operator was expected here.";
 
     return oss.str();
@@ -135,7 +135,7 @@ std::string ParserError::MultilineWoParen(const Token &token) {
     std::ostringstream oss;
     oss << "Multiline expressions must be enclosed in parentheses.\n";
     oss << "--> at line " << token.line << ":\n";
-    oss << "    " << token.line_content << "\n";
+    oss << "    " << token.getLineContent() << "\n";
     oss << "    " << std::string(token.pos, ' ') << "^-- An expression cannot be split across lines here.\n";
     oss << "    " << std::string(token.pos, ' ') << "   Consider wrapping the entire expression in parentheses `()`.";
 
@@ -146,7 +146,7 @@ std::string ParserError::InvalidAssignmentTarget(const Token &token) {
     std::ostringstream oss;
     oss << "Invalid target for assignment.\n";
     oss << "--> at line " << token.line << ":\n";
-    oss << "    " << token.line_content << "\n";
+    oss << "    " << token.getLineContent() << "\n";
     oss << "    " << std::string(token.pos, ' ') << "^-- Cannot assign to this expression.";
     return oss.str();
 }
@@ -155,13 +155,13 @@ std::string ParserError::UnkownFunction(const Token &token) {
     std::ostringstream oss;
     oss << "Unkown function. This should not happen. Please report this bug.\n";
     oss << "--> at line " << token.line << ":\n";
-    oss << "    " << token.line_content << "\n";
+    oss << "    " << token.getLineContent() << "\n";
     oss << "    " << std::string(token.pos, ' ') << "^-- Unkown function.";
     return oss.str();
 }
 
 std::string ParserError::UndefinedVariable(const Token &as, const std::string &variableName) {
-    size_t var_col = as.line_content.find(variableName, as.pos);
+    size_t var_col = as.getLineContent().find(variableName, as.pos);
 
     if (var_col == std::string::npos) {
         var_col = as.pos;
@@ -170,7 +170,7 @@ std::string ParserError::UndefinedVariable(const Token &as, const std::string &v
     std::ostringstream out;
     out << "Use of undefined variable '" << variableName << "'.\n"
             << "--> at line " << as.line << ":\n"
-            << "    " << as.line_content << "\n"
+            << "    " << as.getLineContent() << "\n"
             << "    " << std::string(var_col, ' ')
             << "^-- This variable has not been defined";
 
@@ -181,7 +181,7 @@ std::string ParserError::NotEnoughArguments(const Token &function, int argCount)
     std::ostringstream oss;
     oss << "Function call without sufficient arguments.\n";
     oss << "--> at line " << function.line << ":\n";
-    oss << "    " << function.line_content << "\n";
+    oss << "    " << function.getLineContent() << "\n";
     oss << "    " << std::string(function.pos, ' ') << "^-- '";
     oss << function.value << "' expects " << std::to_string(argCount) << " arguments.";
     return oss.str();
@@ -191,7 +191,7 @@ std::string ParserError::TooManyArguments(const Token &function, int argCount) {
     std::ostringstream oss;
     oss << "Function call with too many arguments.\n";
     oss << "--> at line " << function.line << ":\n";
-    oss << "    " << function.line_content << "\n";
+    oss << "    " << function.getLineContent() << "\n";
     oss << "    " << std::string(function.pos, ' ') << "^-- '";
     oss << function.value << "' expects " << std::to_string(argCount) << " arguments.";
     return oss.str();
@@ -201,7 +201,7 @@ std::string ParserError::MultiArgumentCalledWoParentheses(const Token &function,
     std::ostringstream oss;
     oss << "Multi argument function called without parentheses.\n";
     oss << "--> at line " << function.line << ":\n";
-    oss << "    " << function.line_content << "\n";
+    oss << "    " << function.getLineContent() << "\n";
     oss << "    " << std::string(function.pos, ' ') << "^-- '";
     oss << function.value << "' expects " << std::to_string(argCount) << " arguments. Cannot call without parentheses.";
     return oss.str();
@@ -211,7 +211,7 @@ std::string ParserError::EmptyArgument(const Token& comma) {
     std::ostringstream oss;
     oss << "An expression was expected for an argument, but none was found.\n";
     oss << "--> at line " << comma.line << ":\n";
-    oss << "    " << comma.line_content << "\n";
+    oss << "    " << comma.getLineContent() << "\n";
     oss << "    " << std::string(comma.pos, ' ') << "^-- Expected an argument here";
     return oss.str();
 }
@@ -220,7 +220,7 @@ std::string ParserError::AssignmentToLiteralValue(const std::string &var, const
     std::ostringstream oss;
     oss << "Assigment to constant value '" + var + "'.\n";
     oss << "--> at line " << token.line << ":\n";
-    oss << "    " << token.line_content << "\n";
+    oss << "    " << token.getLineContent() << "\n";
     oss << "    " << std::string(token.pos, ' ') << "^-- Cannot assign to this variable.";
     return oss.str();
 }
@@ -229,7 +229,7 @@ std::string ParserError::AssignmentToPredefinedFunction(const std::string &fun,
     std::ostringstream oss;
     oss << "Assigment to predefined function '" + fun + "'.\n";
     oss << "--> at line " << token.line << ":\n";
-    oss << "    " << token.line_content << "\n";
+    oss << "    " << token.getLineContent() << "\n";
     oss << "    " << std::string(token.pos, ' ') << "^-- Cannot assign to this function.";
     return oss.str();
 }
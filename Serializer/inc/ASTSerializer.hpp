@@ -0,0 +1,71 @@
+//
+// Created by Erhan Türker on 10/16/26.
+//
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../../Node/inc/Node.hpp"
+
+/*
+ * Binary AST format, all integers are unsigned LEB128 varints unless noted:
+ *   header   "M2AT" magic, version
+ *   symbols  count, then length + bytes of every distinct node value and parameter name
+ *   entries  count, then for every entry its parameter count and parameter symbol ids, followed by its tree
+ *   node     type tag byte (0xFF for a null statement), value symbol id,
+ *            8 byte little-endian IEEE-754 double for Number nodes, child count, then the children
+ * Nodes are stored in preorder so a reader never needs to seek. Child counts must be ones the parser produces,
+ * and a function definition needs at least one parameter.
+ */
+namespace ASTFormat {
+    inline constexpr char magic[4] = {'M', '2', 'A', 'T'};
+    inline constexpr uint64_t version = 1;
+    inline constexpr uint8_t nullTag = 0xFF;
+
+    struct Entry {
+        NodePtr statement;
+        std::vector<std::string> parameters; /* Parameters of the function the statement defines, if any */
+    };
+}
+
+class ASTWriter {
+    std::unordered_map<std::string, uint64_t> symbolIds;
+    std::vector<const std::string *> symbols;
+    std::string body;
+    uint64_t entryCount = 0;
+
+    uint64_t intern(const std::string &symbol);
+    void writeTree(const Node *root);
+
+public:
+    void add(const ConstNodePtr &statement, const std::vector<std::string> &parameters = {});
+
+    /* The complete encoding of every entry added so far */
+    [[nodiscard]] std::string finish() const;
+};
+
+/* Decodes in place, data may point into a memory mapped file and nothing outside [data, data + size) is read. */
+class ASTReader {
+    const unsigned char *cursor;
+    const unsigned char *end;
+    std::vector<std::string_view> symbols;
+    std::string error;
+
+    bool readVarint(uint64_t &value);
+    bool readSymbol(std::string_view &symbol);
+    bool readNode(NodePtr &node, uint64_t &childCount);
+    NodePtr readTree();
+
+public:
+    ASTReader(const char *data, size_t size);
+
+    /* Returns nothing and sets the error if the data is not a complete, supported encoding */
+    std::vector<ASTFormat::Entry> read();
+
+    [[nodiscard]] std::string getError() const;
+};
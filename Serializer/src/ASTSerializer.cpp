@@ -0,0 +1,264 @@
+//
+// Created by Erhan Türker on 10/16/26.
+//
+
+#include "../inc/ASTSerializer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static void writeVarint(std::string &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+static void writeDouble(std::string &out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+}
+
+uint64_t ASTWriter::intern(const std::string &symbol) {
+    auto [it, inserted] = symbolIds.emplace(symbol, symbols.size());
+    if (inserted) symbols.push_back(&it->first);
+    return it->second;
+}
+
+void ASTWriter::writeTree(const Node *root) {
+    std::vector<const Node *> pending{root};
+    while (!pending.empty()) {
+        const Node *node = pending.back();
+        pending.pop_back();
+        if (!node) {
+            body.push_back(static_cast<char>(ASTFormat::nullTag));
+            continue;
+        }
+        body.push_back(static_cast<char>(node->type));
+        writeVarint(body, intern(node->name()));
+        if (node->type == Node::Type::Number) writeDouble(body, node->number);
+        writeVarint(body, node->children.size());
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) pending.push_back(it->get());
+    }
+}
+
+void ASTWriter::add(const ConstNodePtr &statement, const std::vector<std::string> &parameters) {
+    writeVarint(body, parameters.size());
+    for (const auto &parameter: parameters) writeVarint(body, intern(parameter));
+    writeTree(statement.get());
+    entryCount++;
+}
+
+std::string ASTWriter::finish() const {
+    std::string out(ASTFormat::magic, sizeof(ASTFormat::magic));
+    writeVarint(out, ASTFormat::version);
+    writeVarint(out, symbols.size());
+    for (const std::string *symbol: symbols) {
+        writeVarint(out, symbol->size());
+        out += *symbol;
+    }
+    writeVarint(out, entryCount);
+    out += body;
+    return out;
+}
+
+/* Whether the parser could have built the node with that many children */
+static bool isValidChildCount(const Node &node, uint64_t childCount) {
+    switch (node.type) {
+        case Node::Type::Number:
+        case Node::Type::Variable:
+        case Node::Type::Parameter:
+            return childCount == 0;
+        case Node::Type::Assignment:
+        case Node::Type::FunctionAssignment:
+        case Node::Type::Derivative:
+            return childCount == 1;
+        case Node::Type::Operand:
+            switch (node.op) {
+                case Node::Op::Add: return childCount == 1 || childCount == 2; /* A unary plus keeps its node */
+                case Node::Op::Neg:
+                case Node::Op::Fact: return childCount == 1;
+                default: return childCount == 2;
+            }
+        case Node::Type::Function:
+            if (node.op == Node::Op::Atan2) return childCount == 2;
+            return node.op == Node::Op::None ? childCount >= 1 : childCount == 1;
+        default:
+            return false;
+    }
+}
+
+ASTReader::ASTReader(const char *data, size_t size)
+    : cursor(reinterpret_cast<const unsigned char *>(data)), end(reinterpret_cast<const unsigned char *>(data) + size) {
+}
+
+bool ASTReader::readVarint(uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (cursor == end) {
+            error = "Unexpected end of data.";
+            return false;
+        }
+        const unsigned char byte = *cursor++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    error = "Malformed varint.";
+    return false;
+}
+
+bool ASTReader::readSymbol(std::string_view &symbol) {
+    uint64_t id;
+    if (!readVarint(id)) return false;
+    if (id >= symbols.size()) {
+        error = "Symbol id " + std::to_string(id) + " is out of range.";
+        return false;
+    }
+    symbol = symbols[id];
+    return true;
+}
+
+bool ASTReader::readNode(NodePtr &node, uint64_t &childCount) {
+    if (cursor == end) {
+        error = "Unexpected end of data.";
+        return false;
+    }
+    const unsigned char tag = *cursor++;
+    childCount = 0;
+    if (tag == ASTFormat::nullTag) {
+        node = nullptr;
+        return true;
+    }
+    if (tag > static_cast<unsigned char>(Node::Type::Derivative)) {
+        error = "Unknown node type " + std::to_string(tag) + ".";
+        return false;
+    }
+
+    std::string_view value;
+    if (!readSymbol(value)) return false;
+    const auto symbol = SymbolTable::tryIntern(value);
+    if (!symbol) {
+        error = "Symbol table is full.";
+        return false;
+    }
+    node = makeNode(static_cast<Node::Type>(tag), *symbol);
+    if (node->type == Node::Type::Number) {
+        if (end - cursor < 8) {
+            error = "Unexpected end of data.";
+            return false;
+        }
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) bits |= static_cast<uint64_t>(cursor[i]) << (8 * i);
+        std::memcpy(&node->number, &bits, sizeof(bits));
+        cursor += 8;
+    }
+    if (!readVarint(childCount)) return false;
+    if (node->op == Node::Op::Sub && childCount == 1) node->op = Node::Op::Neg; /* A minus with one operand is a negation */
+    if (node->type == Node::Type::Operand && node->op == Node::Op::None) {
+        error = "Unknown operator '" + node->name() + "'.";
+        return false;
+    }
+    if (!isValidChildCount(*node, childCount)) {
+        const std::string label = node->type == Node::Type::Number ? "a number" : "'" + node->name() + "'";
+        error = std::to_string(childCount) + " children are not valid for " + label + ".";
+        return false;
+    }
+    /* Every child takes at least one byte, larger counts can only come from corrupt data */
+    if (childCount > static_cast<uint64_t>(end - cursor)) {
+        error = "Child count exceeds the remaining data.";
+        return false;
+    }
+    return true;
+}
+
+NodePtr ASTReader::readTree() {
+    NodePtr root;
+    std::vector<std::pair<Node *, uint64_t>> pending; /* Nodes still waiting for children */
+    do {
+        NodePtr node;
+        uint64_t childCount;
+        if (!readNode(node, childCount)) return nullptr;
+        Node *raw = node.get();
+        if (!node && !pending.empty()) {
+            error = "Missing child of '" + pending.back().first->name() + "'.";
+            return nullptr;
+        }
+        if (pending.empty()) {
+            root = std::move(node);
+        } else {
+            pending.back().first->children.push_back(std::move(node));
+            pending.back().second--;
+        }
+        if (childCount > 0) {
+            raw->children.reserve(childCount);
+            pending.emplace_back(raw, childCount);
+        }
+        while (!pending.empty() && pending.back().second == 0) pending.pop_back();
+    } while (!pending.empty());
+    return root;
+}
+
+std::vector<ASTFormat::Entry> ASTReader::read() {
+    error.clear();
+    symbols.clear();
+    if (end - cursor < static_cast<std::ptrdiff_t>(sizeof(ASTFormat::magic))
+        || std::memcmp(cursor, ASTFormat::magic, sizeof(ASTFormat::magic)) != 0) {
+        error = "Not a serialized AST.";
+        return {};
+    }
+    cursor += sizeof(ASTFormat::magic);
+
+    uint64_t version;
+    if (!readVarint(version)) return {};
+    if (version != ASTFormat::version) {
+        error = "Unsupported AST format version " + std::to_string(version) + ".";
+        return {};
+    }
+
+    uint64_t symbolCount;
+    if (!readVarint(symbolCount)) return {};
+    symbols.reserve(std::min<uint64_t>(symbolCount, end - cursor));
+    for (uint64_t i = 0; i < symbolCount; ++i) {
+        uint64_t length;
+        if (!readVarint(length)) return {};
+        if (length > static_cast<uint64_t>(end - cursor)) {
+            error = "Unexpected end of data.";
+            return {};
+        }
+        symbols.emplace_back(reinterpret_cast<const char *>(cursor), length);
+        cursor += length;
+    }
+
+    uint64_t entryCount;
+    if (!readVarint(entryCount)) return {};
+    std::vector<ASTFormat::Entry> entries;
+    entries.reserve(std::min<uint64_t>(entryCount, end - cursor));
+    for (uint64_t i = 0; i < entryCount; ++i) {
+        ASTFormat::Entry entry;
+        uint64_t parameterCount;
+        if (!readVarint(parameterCount)) return {};
+        for (uint64_t j = 0; j < parameterCount; ++j) {
+            std::string_view parameter;
+            if (!readSymbol(parameter)) return {};
+            entry.parameters.emplace_back(parameter);
+        }
+        entry.statement = readTree();
+        if (!error.empty()) return {};
+        if (entry.statement && entry.statement->type == Node::Type::FunctionAssignment && entry.parameters.empty()) {
+            error = "Function '" + entry.statement->name() + "' has no parameters.";
+            return {};
+        }
+        entries.push_back(std::move(entry));
+    }
+    if (cursor != end) {
+        error = "Trailing data after the last entry.";
+        return {};
+    }
+    return entries;
+}
+
+std::string ASTReader::getError() const {
+    return error;
+}
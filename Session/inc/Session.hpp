@@ -0,0 +1,36 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#pragma once
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "../../Evaluator/inc/Evaluator.hpp"
+#include "../../Parser/inc/IncrementalParser.hpp"
+#include "../../Parser/inc/Parser.hpp"
+#include "../../SymbolicEvaluator/inc/SymbolicEvaluator.hpp"
+
+/* Runs input through the engine and writes what the user sees, shared by the server and script mode. */
+
+/* Prints the result of a single parsed statement.
+   Unsimplified statements are evaluated as they are and only simplified and expanded when that does not give a number. */
+void processStatement(const NodePtr& node, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::ostream& out, bool simplified = true);
+
+/* With recover set, statements with syntax errors are reported in place and the rest still run */
+void processInput(const std::string& input, Parser& parser, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::ostream& out, bool recover = false);
+
+/* Like processInput, but only lexes and parses the statements of the cell that changed since it last ran */
+void processCell(int cellId, const std::string& input, IncrementalParser& incrementalParser, Parser& parser, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::ostream& out);
+
+/* Streams a script statement by statement, so only the statement being processed is held in memory.
+   Statements before an error have already been evaluated and printed. */
+void processStream(std::istream& input, Parser& parser, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::ostream& out);
+
+/* Registers the functions of a library written by saveLibrary without lexing or parsing them again.
+   The file is memory mapped and decoded in place. A name that is already defined keeps its definition. */
+bool loadLibrary(const std::string& path, Parser& parser, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::ostream& out);
+
+/* Writes every function defined so far, in name order so the same session always gives the same file */
+bool saveLibrary(const std::string& path, const Parser& parser, const SymbolicEvaluator& sEvaluator);
@@ -0,0 +1,214 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include "../inc/Session.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../../Lexer/inc/StatementReader.hpp"
+#include "../../Serializer/inc/ASTSerializer.hpp"
+#include "../../Simplifier/inc/Simplifier.hpp"
+#include "../../Util/inc/ASTPrint.hpp"
+
+void processStatement(const NodePtr& node, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::ostream& out, bool simplified) {
+    // --- CASE 1: DEFINITIONS (f(x) = ...) ---
+    if (node->type == Node::Type::FunctionAssignment) {
+        // 1. Expand symbolicly (resolve d/dx, simplify)
+        // Raw definitions are simplified first so they come out the way the parser would have simplified them
+        auto expandedNode = sEvaluator.expand(simplified ? node : Simplifier::simplify(node));
+
+        // 2. Register Symbolic
+        sEvaluator.registerFunction(expandedNode);
+
+        // 3. Register Numeric (So we can plot it)
+        evaluator.evaluate(expandedNode);
+
+        out << "Defined: " << toHumanReadable(expandedNode) << "\n";
+        return;
+    }
+
+    // --- CASE 2: EXPRESSIONS (d/dx(x), 5+5, etc.) ---
+
+    // Raw statements (e.g. plot batches) skip the Simplifier when they are purely numeric
+    if (!simplified) {
+        double val = evaluator.evaluate(node);
+        if (evaluator.getError().empty()) {
+            if (node->type != Node::Type::Assignment) {
+                out << val << "\n";
+            } else {
+                out << toHumanReadable(node) << " = " << val << "\n";
+            }
+            return;
+        }
+    }
+
+    // STEP 1: Always Expand First!
+    // This converts "d/dx(x)" -> "1" BEFORE we try to calculate it.
+    // A raw statement that got here is simplified now, so it prints the same as in simplified mode
+    auto expandedNode = sEvaluator.expand(simplified ? node : Simplifier::simplify(node));
+
+    // STEP 2: Try Numeric Evaluation on the expanded result
+    double val = evaluator.evaluate(expandedNode);
+    std::string evalError = evaluator.getError();
+
+    if (evalError.empty()) {
+        // Success: It's a number (e.g., 1, 10, 0.5)
+        if (node->type != Node::Type::Assignment) {
+             out << val << "\n";
+        } else {
+             // Variable Assignment: x = 5
+             out << toHumanReadable(expandedNode) << " = " << val << "\n";
+        }
+    } else {
+        // Failure: It's likely purely symbolic (e.g., "x + y" where y is unknown)
+        // We just print the expanded symbolic form.
+        out << "--> " << toHumanReadable(expandedNode) << "\n";
+    }
+}
+
+void processInput(const std::string& input, Parser& parser, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::ostream& out, bool recover) {
+    if (input.empty()) return;
+
+    // --- NEW: Handle "clear x" ---
+    if (input.substr(0, 6) == "clear ") {
+        std::string varName = input.substr(6);
+        // Trim whitespace
+        varName.erase(0, varName.find_first_not_of(" \n\r\t"));
+        varName.erase(varName.find_last_not_of(" \n\r\t") + 1);
+
+        evaluator.clearVariable(varName);
+        sEvaluator.clearVariable(varName);
+        out << "Variable '" << varName << "' cleared.\n";
+        return;
+    }
+
+    Lexer lexer = Lexer::createParallel(input);
+    if (!lexer.getError().empty()) {
+        out << "Error: " << lexer.getError() << "\n";
+        return;
+    }
+
+    auto ast = parser.parse(lexer, recover);
+    if (!parser.getError().empty()) {
+        out << "Error: " << parser.getError() << "\n";
+        parser.clearError();
+        return;
+    }
+
+    const auto& errors = parser.getStatementErrors();
+    size_t nextError = 0;
+    for (size_t i = 0; i <= ast.size(); ++i) {
+        while (nextError < errors.size() && errors[nextError].statementIndex == i) {
+            out << "Error: " << errors[nextError++].message << "\n";
+        }
+        if (i < ast.size()) processStatement(ast[i], evaluator, sEvaluator, out, parser.isSimplifying());
+    }
+}
+
+void processCell(int cellId, const std::string& input, IncrementalParser& incrementalParser, Parser& parser, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::ostream& out) {
+    if (input.empty() || input.substr(0, 6) == "clear ") {
+        processInput(input, parser, evaluator, sEvaluator, out);
+        return;
+    }
+
+    auto ast = incrementalParser.parse(cellId, input, parser);
+    if (!incrementalParser.getError().empty()) {
+        out << "Error: " << incrementalParser.getError() << "\n";
+        return;
+    }
+
+    for (const auto& node : ast) {
+        processStatement(node, evaluator, sEvaluator, out, parser.isSimplifying());
+    }
+}
+
+void processStream(std::istream& input, Parser& parser, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::ostream& out) {
+    StatementReader reader(input);
+    std::string statement;
+    int firstLine = 1;
+
+    while (reader.next(statement, firstLine)) {
+        Lexer lexer(statement, firstLine);
+        if (!lexer.getError().empty()) {
+            out << "Error: " << lexer.getError() << "\n";
+            return;
+        }
+
+        auto ast = parser.parse(lexer);
+        if (!parser.getError().empty()) {
+            out << "Error: " << parser.getError() << "\n";
+            parser.clearError();
+            return;
+        }
+
+        for (const auto& node : ast) {
+            processStatement(node, evaluator, sEvaluator, out);
+        }
+    }
+}
+
+bool loadLibrary(const std::string& path, Parser& parser, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::ostream& out) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        out << "Could not open " << path << "\n";
+        return false;
+    }
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        out << "Could not read " << path << "\n";
+        return false;
+    }
+
+    const auto size = static_cast<size_t>(info.st_size);
+    void* data = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+    close(fd);
+    if (data == MAP_FAILED) {
+        out << "Could not map " << path << "\n";
+        return false;
+    }
+
+    ASTReader reader(static_cast<const char*>(data), size);
+    auto entries = reader.read();
+    if (data) munmap(data, size);
+    if (!reader.getError().empty()) {
+        out << "Error: " << path << ": " << reader.getError() << "\n";
+        return false;
+    }
+
+    for (const auto& entry : entries) {
+        if (!entry.statement || entry.statement->type != Node::Type::FunctionAssignment) continue;
+        /* The parser keeps the first definition of a name, so the evaluators may not take a later one either */
+        if (parser.resolveSymbol(entry.statement->symbol).argCount >= 0) continue;
+        parser.declare(entry.statement, entry.parameters);
+        sEvaluator.registerFunction(entry.statement);
+        evaluator.evaluate(entry.statement);
+    }
+    return true;
+}
+
+bool saveLibrary(const std::string& path, const Parser& parser, const SymbolicEvaluator& sEvaluator) {
+    std::vector<std::pair<SymbolId, ConstNodePtr>> functions;
+    sEvaluator.getFunctions().forEach([&](SymbolId name, const ConstNodePtr& definition) { functions.emplace_back(name, definition); });
+    std::sort(functions.begin(), functions.end(), [](const auto& a, const auto& b) {
+        return SymbolTable::name(a.first) < SymbolTable::name(b.first);
+    });
+
+    ASTWriter writer;
+    for (const auto& [name, definition] : functions) {
+        writer.add(definition, parser.getFunctionParameters(name));
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    const std::string data = writer.finish();
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
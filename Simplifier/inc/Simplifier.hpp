@@ -9,59 +9,50 @@
 
 struct Term {
     double coefficient;
-    std::shared_ptr<Node> variablePart; // nullptr for constants
+    NodePtr variablePart; // nullptr for constants
 
-    Term(double coefficient, std::shared_ptr<Node> varPart)
+    Term(double coefficient, NodePtr varPart)
         : coefficient(coefficient), variablePart(std::move(varPart)) {}
-
-    [[nodiscard]] std::string getKey() const {
-        if (variablePart == nullptr) {
-            return "##CONST##";
-        }
-        return toLisp(variablePart);
-    }
 };
 
 struct TermData {
     double coefficient = 0.0;
-    std::shared_ptr<Node> variablePart = nullptr;
+    NodePtr variablePart = nullptr;
     double power = 0.0;
 };
 
 struct Factor {
-    std::shared_ptr<Node> base;
+    NodePtr base;
     double power;
 
-    Factor(std::shared_ptr<Node> b, double p) : base(std::move(b)), power(p) {}
-
-    [[nodiscard]] std::string getKey() const { return toLisp(base); }
+    Factor(NodePtr b, double p) : base(std::move(b)), power(p) {}
 };
 
 struct FactorData {
     double totalPower = 0.0;
-    std::shared_ptr<Node> base = nullptr;
+    NodePtr base = nullptr;
 };
 
 
 class Simplifier {
-    static TermData getTermParts(const std::shared_ptr<Node>& node);
-    static void collectSumTermsImpl(const std::shared_ptr<Node>& node, double currentSign, std::list<Term>& terms);
-    static std::list<Term> collectSumTerms(const std::shared_ptr<Node>& node);
+    static TermData getTermParts(const NodePtr& node);
+    static void collectSumTermsImpl(const NodePtr& node, double currentSign, std::list<Term>& terms);
+    static std::list<Term> collectSumTerms(const NodePtr& node);
     static bool isSum(const Term& term);
     static std::list<Term> expandTerm(const Term& term);
-    static std::shared_ptr<Node> simplifySum(const std::shared_ptr<Node> &node);
+    static NodePtr simplifySum(const NodePtr &node);
 
-    static void collectProductFactorsImpl(const std::shared_ptr<Node>& node, double currentPower, std::list<Factor>& factors);
-    static std::list<Factor> collectProductFactors(const std::shared_ptr<Node>& node);
+    static void collectProductFactorsImpl(const NodePtr& node, double currentPower, std::list<Factor>& factors);
+    static std::list<Factor> collectProductFactors(const NodePtr& node);
     static bool isProduct(const Factor& factor);
     static std::list<Factor> expandFactor(const Factor& factor);
-    static std::shared_ptr<Node> simplifyProduct(const std::shared_ptr<Node> &node);
+    static NodePtr simplifyProduct(const NodePtr &node);
 
-    static std::shared_ptr<Node> simplifyPower(const std::shared_ptr<Node> &node);
-    static std::shared_ptr<Node> constantFoldNode(std::shared_ptr<Node> node);
+    static NodePtr simplifyPower(const NodePtr &node);
+    static NodePtr constantFoldNode(NodePtr node);
 
-    static std::shared_ptr<Node> simplifyNode(std::shared_ptr<Node> node);
+    static NodePtr simplifyNode(NodePtr node);
 public:
-    static std::shared_ptr<Node> simplify(const std::shared_ptr<Node>& node);
+    static NodePtr simplify(const NodePtr& node);
 };
 
@@ -3,26 +3,62 @@
 //
 
 #include "../inc/Simplifier.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
 #include "../../Util/inc/ASTUtil.hpp"
 
-TermData Simplifier::getTermParts(const std::shared_ptr<Node>& node) { // NOLINT(*-no-recursion)
+/* Position of the expression structurally equal to node among the representatives, appended if there is none.
+   Candidates come from the cached hash and are confirmed with Node::equal, so a collision never merges two terms. */
+static size_t findRepresentative(std::vector<const Node*>& representatives, std::unordered_multimap<uint64_t, size_t>& byHash, const Node* node) {
+    const uint64_t hash = node ? node->getHash() : 0;
+    auto [first, last] = byHash.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (Node::equal(representatives[it->second], node)) return it->second;
+    }
+    byHash.emplace(hash, representatives.size());
+    representatives.push_back(node);
+    return representatives.size() - 1;
+}
+
+/* Representative indices in the order of their printed forms, which fixes the order terms are written back in.
+   A null representative stands for the constant term, which sorts first. */
+static std::vector<size_t> getPrintedOrder(const std::vector<const Node*>& representatives) {
+    std::vector<std::string> printedForms;
+    printedForms.reserve(representatives.size());
+    for (const Node* node : representatives) {
+        std::ostringstream out;
+        if (node) toLispImpl(node, out); else out << "##CONST##";
+        printedForms.push_back(out.str());
+    }
+    std::vector<size_t> order(representatives.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return printedForms[a] < printedForms[b];
+    });
+    return order;
+}
+
+TermData Simplifier::getTermParts(const NodePtr& node) { // NOLINT(*-no-recursion)
     if (isNumber(node)) {
         return {getValue(node), nullptr};
     }
 
-    if (node->type == Node::Type::Operand && node->value == "*") {
+    if (node->op == Node::Op::Mul) {
         auto leftParts = getTermParts(node->children[0]);
         auto rightParts = getTermParts(node->children[1]);
 
         double newCoefficient = leftParts.coefficient * rightParts.coefficient;
 
-        std::shared_ptr<Node> newVarPart = nullptr;
+        NodePtr newVarPart = nullptr;
         if (leftParts.variablePart == nullptr) {
             newVarPart = rightParts.variablePart;
         } else if (rightParts.variablePart == nullptr) {
             newVarPart = leftParts.variablePart;
         } else {
-            newVarPart = std::make_shared<Node>(Node::Type::Operand, "*");
+            newVarPart = makeNode(Node::Type::Operand, "*");
             newVarPart->children.push_back(leftParts.variablePart);
             newVarPart->children.push_back(rightParts.variablePart);
         }
@@ -30,7 +66,7 @@ TermData Simplifier::getTermParts(const std::shared_ptr<Node>& node) { // NOLINT
         return {newCoefficient, newVarPart};
     }
 
-    if (node->type == Node::Type::Operand && node->value == "-" && node->children.size() == 1) {
+    if (node->op == Node::Op::Neg) {
         auto parts = getTermParts(node->children[0]);
         parts.coefficient *= -1.0;
         return parts;
@@ -39,8 +75,8 @@ TermData Simplifier::getTermParts(const std::shared_ptr<Node>& node) { // NOLINT
     return {1.0, node};
 }
 
-static Factor getFactorParts(const std::shared_ptr<Node>& node) {
-    if (node->type == Node::Type::Operand && node->value == "^") {
+static Factor getFactorParts(const NodePtr& node) {
+    if (node->op == Node::Op::Pow) {
         if (isNumber(node->children[1])) {
             return {node->children[0], getValue(node->children[1])};
         }
@@ -48,26 +84,26 @@ static Factor getFactorParts(const std::shared_ptr<Node>& node) {
     return {node, 1.0};
 }
 
-void Simplifier::collectSumTermsImpl(const std::shared_ptr<Node>& node, double currentSign, std::list<Term>& terms) { // NOLINT(*-no-recursion)
+void Simplifier::collectSumTermsImpl(const NodePtr& node, double currentSign, std::list<Term>& terms) { // NOLINT(*-no-recursion)
 
-    if (node->type == Node::Type::Operand && node->value == "+" && node->children.size() == 2) {
+    if (node->op == Node::Op::Add && node->children.size() == 2) {
         collectSumTermsImpl(node->children[0], currentSign, terms);
         collectSumTermsImpl(node->children[1], currentSign, terms);
         return;
     }
 
-    if (node->type == Node::Type::Operand && node->value == "-" && node->children.size() == 2) {
+    if (node->op == Node::Op::Sub) {
         collectSumTermsImpl(node->children[0], currentSign, terms);
         collectSumTermsImpl(node->children[1], -currentSign, terms);
         return;
     }
 
-    if (node->type == Node::Type::Operand && node->value == "-" && node->children.size() == 1) {
+    if (node->op == Node::Op::Neg) {
         collectSumTermsImpl(node->children[0], -currentSign, terms);
         return;
     }
 
-    if (node->type == Node::Type::Operand && node->value == "+" && node->children.size() == 1) {
+    if (node->op == Node::Op::Add && node->children.size() == 1) {
         collectSumTermsImpl(node->children[0], currentSign, terms);
         return;
     }
@@ -75,20 +111,20 @@ void Simplifier::collectSumTermsImpl(const std::shared_ptr<Node>& node, double c
     auto parts = getTermParts(node);
 
     double finalCoefficient = parts.coefficient * currentSign;
-    std::shared_ptr<Node> variablePart = parts.variablePart;
 
-    terms.emplace_back(finalCoefficient, variablePart);
+    terms.emplace_back(finalCoefficient, std::move(parts.variablePart));
 }
 
-std::list<Term> Simplifier::collectSumTerms(const std::shared_ptr<Node>& node) {
+std::list<Term> Simplifier::collectSumTerms(const NodePtr& node) {
     std::list<Term> terms;
     collectSumTermsImpl(node, 1, terms);
     return terms;
 }
 
 bool Simplifier::isSum(const Term& term) {
-    if (term.variablePart == nullptr || term.variablePart->type != Node::Type::Operand) return false;
-    return term.variablePart->value == "+" || term.variablePart->value == "-";
+    if (term.variablePart == nullptr) return false;
+    const Node::Op op = term.variablePart->op;
+    return op == Node::Op::Add || op == Node::Op::Sub || op == Node::Op::Neg;
 }
 
 std::list<Term> Simplifier::expandTerm(const Term& term) {
@@ -103,7 +139,7 @@ std::list<Term> Simplifier::expandTerm(const Term& term) {
     return innerTerms;
 }
 
-std::shared_ptr<Node> Simplifier::simplifySum(const std::shared_ptr<Node>& node) {
+NodePtr Simplifier::simplifySum(const NodePtr& node) {
     std::list<Term> collectedTerms = collectSumTerms(node);
     std::list<Term> expandedTerms;
     for (const auto& term : collectedTerms) {
@@ -111,50 +147,46 @@ std::shared_ptr<Node> Simplifier::simplifySum(const std::shared_ptr<Node>& node)
         expandedTerms.splice(expandedTerms.end(), distributedTerms);
     }
 
-    std::map<std::string, TermData> finalTerms;
+    std::vector<TermData> finalTerms;
+    std::vector<const Node*> representatives;
+    std::unordered_multimap<uint64_t, size_t> byHash;
     for (const auto& term : expandedTerms) {
-        std::string key = term.getKey();
-        finalTerms[key].coefficient += term.coefficient;
-        if (finalTerms[key].variablePart == nullptr) {
-            finalTerms[key].variablePart = term.variablePart;
-        }
+        const size_t index = findRepresentative(representatives, byHash, term.variablePart.get());
+        if (index == finalTerms.size()) finalTerms.push_back({0.0, term.variablePart});
+        finalTerms[index].coefficient += term.coefficient;
     }
 
-    std::shared_ptr<Node> root = nullptr;
-    for (auto const& [key, data] : finalTerms) {
+    NodePtr root = nullptr;
+    for (size_t index : getPrintedOrder(representatives)) {
+        const TermData& data = finalTerms[index];
 
         if (data.coefficient == 0.0) {
             continue;
         }
-        std::shared_ptr<Node> termNode = nullptr;
+        // Every term after the first is added or subtracted by its magnitude
+        const bool subtract = root != nullptr && data.coefficient < 0.0;
+        const double coefficient = subtract ? -data.coefficient : data.coefficient;
+        NodePtr termNode = nullptr;
 
-        if (key == "##CONST##") {
-            termNode = Node::createNode(data.coefficient);
+        if (data.variablePart == nullptr) {
+            termNode = Node::createNode(coefficient);
         } else {
-            if (data.coefficient == 1.0) {
+            if (coefficient == 1.0) {
                 termNode = data.variablePart;
-            }else if (data.coefficient == -1.0) {
-                termNode = std::make_shared<Node>(Node::Type::Operand, "-");
-                termNode->children.push_back(data.variablePart);
+            }else if (coefficient == -1.0) {
+                termNode = Node::createNegation(data.variablePart);
             }else {
-                termNode = std::make_shared<Node>(Node::Type::Operand, "*");
-                termNode->children.push_back(Node::createNode(data.coefficient));
+                termNode = makeNode(Node::Type::Operand, "*");
+                termNode->children.push_back(Node::createNode(coefficient));
                 termNode->children.push_back(data.variablePart);
             }
         }
 
         if (root == nullptr) {
             root = termNode;
-        } else if (data.coefficient >= 0){
-            auto newRoot = std::make_shared<Node>(Node::Type::Operand, "+");
-            newRoot->children.push_back(root);
-            newRoot->children.push_back(termNode);
-            root = newRoot;
-        }
-        else {
-            auto newRoot = std::make_shared<Node>(Node::Type::Operand, "-");
+        } else {
+            auto newRoot = makeNode(Node::Type::Operand, subtract ? "-" : "+");
             newRoot->children.push_back(root);
-            termNode = std::move(termNode->children.back());
             newRoot->children.push_back(termNode);
             root = newRoot;
         }
@@ -167,14 +199,14 @@ std::shared_ptr<Node> Simplifier::simplifySum(const std::shared_ptr<Node>& node)
     return root;
 }
 
-void Simplifier::collectProductFactorsImpl(const std::shared_ptr<Node>& node, double currentPower, std::list<Factor>& factors) { // NOLINT(*-no-recursion)
-    if (node->type == Node::Type::Operand && node->value == "*") {
+void Simplifier::collectProductFactorsImpl(const NodePtr& node, double currentPower, std::list<Factor>& factors) { // NOLINT(*-no-recursion)
+    if (node->op == Node::Op::Mul) {
         collectProductFactorsImpl(node->children[0], currentPower, factors);
         collectProductFactorsImpl(node->children[1], currentPower, factors);
         return;
     }
 
-    if (node->type == Node::Type::Operand && node->value == "/") {
+    if (node->op == Node::Op::Div) {
         collectProductFactorsImpl(node->children[0], currentPower, factors);
         collectProductFactorsImpl(node->children[1], -currentPower, factors);
         return;
@@ -187,15 +219,15 @@ void Simplifier::collectProductFactorsImpl(const std::shared_ptr<Node>& node, do
     factors.emplace_back(parts.base, parts.power);
 }
 
-std::list<Factor> Simplifier::collectProductFactors(const std::shared_ptr<Node>& node) {
+std::list<Factor> Simplifier::collectProductFactors(const NodePtr& node) {
     std::list<Factor> factors;
     collectProductFactorsImpl(node, 1.0, factors);
     return factors;
 }
 
 bool Simplifier::isProduct(const Factor& factor) {
-    if (factor.base == nullptr || factor.base->type != Node::Type::Operand) return false;
-    return factor.base->value == "*" || factor.base->value == "/";
+    if (factor.base == nullptr) return false;
+    return factor.base->op == Node::Op::Mul || factor.base->op == Node::Op::Div;
 }
 
 std::list<Factor> Simplifier::expandFactor(const Factor& factor) {
@@ -209,7 +241,7 @@ std::list<Factor> Simplifier::expandFactor(const Factor& factor) {
     return innerFactors;
 }
 
-std::shared_ptr<Node> Simplifier::simplifyProduct(const std::shared_ptr<Node> &node) { // NOLINT(*-no-recursion)
+NodePtr Simplifier::simplifyProduct(const NodePtr &node) { // NOLINT(*-no-recursion)
     std::list<Factor> collectedFactors = collectProductFactors(node);
     std::list<Factor> expandedFactors;
     for (const auto& factor : collectedFactors) {
@@ -218,22 +250,22 @@ std::shared_ptr<Node> Simplifier::simplifyProduct(const std::shared_ptr<Node> &n
     }
 
     double totalCoefficient = 1.0;
-    std::map<std::string, FactorData> finalFactors;
+    std::vector<FactorData> finalFactors;
+    std::vector<const Node*> representatives;
+    std::unordered_multimap<uint64_t, size_t> byHash;
 
     for (auto& factor : expandedFactors) {
         if (isNumber(factor.base)) {
             totalCoefficient *= std::pow(getValue(factor.base), factor.power);
         } else {
-            std::string key = factor.getKey();
-            finalFactors[key].totalPower += factor.power;
-            if (finalFactors[key].base == nullptr) {
-                finalFactors[key].base = factor.base;
-            }
+            const size_t index = findRepresentative(representatives, byHash, factor.base.get());
+            if (index == finalFactors.size()) finalFactors.push_back({0.0, factor.base});
+            finalFactors[index].totalPower += factor.power;
         }
     }
 
-    std::list<std::shared_ptr<Node>> numeratorFactors;
-    std::list<std::shared_ptr<Node>> denominatorFactors;
+    std::list<NodePtr> numeratorFactors;
+    std::list<NodePtr> denominatorFactors;
 
     double invCoefficient = 1.0 / totalCoefficient;
     if (invCoefficient == std::floor(invCoefficient) && invCoefficient != 1.0) {
@@ -242,7 +274,8 @@ std::shared_ptr<Node> Simplifier::simplifyProduct(const std::shared_ptr<Node> &n
         numeratorFactors.push_back(Node::createNode(totalCoefficient));
     }
 
-    for (auto const& [key, data] : finalFactors) {
+    for (size_t index : getPrintedOrder(representatives)) {
+        const FactorData& data = finalFactors[index];
         if (data.totalPower == 0.0) {
             continue;
         }
@@ -270,14 +303,14 @@ std::shared_ptr<Node> Simplifier::simplifyProduct(const std::shared_ptr<Node> &n
         }
     }
 
-    std::shared_ptr<Node> numTree = nullptr;
+    NodePtr numTree = nullptr;
     if (numeratorFactors.empty()) {
         numTree = Node::createNode(1.0);
     } else {
         numTree = numeratorFactors.front();
         numeratorFactors.pop_front();
         while(!numeratorFactors.empty()) {
-            auto newRoot = std::make_shared<Node>(Node::Type::Operand, "*");
+            auto newRoot = makeNode(Node::Type::Operand, "*");
             newRoot->children.push_back(numTree);
             newRoot->children.push_back(numeratorFactors.front());
             numeratorFactors.pop_front();
@@ -289,24 +322,24 @@ std::shared_ptr<Node> Simplifier::simplifyProduct(const std::shared_ptr<Node> &n
         return numTree;
     }
 
-    std::shared_ptr<Node> denTree = denominatorFactors.front();
+    NodePtr denTree = denominatorFactors.front();
     denominatorFactors.pop_front();
     while(!denominatorFactors.empty()) {
-        auto newRoot = std::make_shared<Node>(Node::Type::Operand, "*");
+        auto newRoot = makeNode(Node::Type::Operand, "*");
         newRoot->children.push_back(denTree);
         newRoot->children.push_back(denominatorFactors.front());
         denominatorFactors.pop_front();
         denTree = newRoot;
     }
 
-    auto finalRoot = std::make_shared<Node>(Node::Type::Operand, "/");
+    auto finalRoot = makeNode(Node::Type::Operand, "/");
     finalRoot->children.push_back(simplifyNode(numTree));
     finalRoot->children.push_back(simplifyNode(denTree));
 
     return finalRoot;
 }
 
-std::shared_ptr<Node> Simplifier::constantFoldNode(std::shared_ptr<Node> node) {
+NodePtr Simplifier::constantFoldNode(NodePtr node) {
     bool allChildrenAreNumbers = !node->children.empty();
     for (const auto& child : node->children) {
         if (!isNumber(child)) {
@@ -317,41 +350,46 @@ std::shared_ptr<Node> Simplifier::constantFoldNode(std::shared_ptr<Node> node) {
 
     if (allChildrenAreNumbers) {
         try {
-            const std::string& op = node->value;
-            // Operators
-            if (op == "+" && node->children.size() == 2) {
-                return Node::createNode(getValue(node->children[0]) + getValue(node->children[1]));
-            }
-            if (op == "-" && node->children.size() == 2) {
-                return Node::createNode(getValue(node->children[0]) - getValue(node->children[1]));
-            }
-            if (op == "*" && node->children.size() == 2) {
-                return Node::createNode(getValue(node->children[0]) * getValue(node->children[1]));
-            }
-            if (op == "/" && node->children.size() == 2) {
-                double divisor = getValue(node->children[1]);
-                if (divisor == 0.0) return node;
-                return Node::createNode(getValue(node->children[0]) / divisor);
-            }
-            if (op == "^" && node->children.size() == 2) {
-                return Node::createNode(std::pow(getValue(node->children[0]), getValue(node->children[1])));
+            const size_t arity = node->children.size();
+            switch (node->op) {
+                // Operators
+                case Node::Op::Add:
+                    if (arity == 2) return Node::createNode(getValue(node->children[0]) + getValue(node->children[1]));
+                    break;
+                case Node::Op::Sub:
+                    if (arity == 2) return Node::createNode(getValue(node->children[0]) - getValue(node->children[1]));
+                    break;
+                case Node::Op::Mul:
+                    if (arity == 2) return Node::createNode(getValue(node->children[0]) * getValue(node->children[1]));
+                    break;
+                case Node::Op::Div:
+                    if (arity == 2) {
+                        double divisor = getValue(node->children[1]);
+                        if (divisor == 0.0) return node;
+                        return Node::createNode(getValue(node->children[0]) / divisor);
+                    }
+                    break;
+                case Node::Op::Pow:
+                    if (arity == 2) return Node::createNode(std::pow(getValue(node->children[0]), getValue(node->children[1])));
+                    break;
+                case Node::Op::Neg:
+                    if (arity == 1) return Node::createNode(-getValue(node->children[0]));
+                    break;
+                case Node::Op::Fact:
+                    if (arity == 1) return Node::createNode(factorial(getValue(node->children[0])));
+                    break;
+
+                // Functions
+                case Node::Op::Sin: if (arity == 1) return Node::createNode(std::sin(getValue(node->children[0]))); break;
+                case Node::Op::Cos: if (arity == 1) return Node::createNode(std::cos(getValue(node->children[0]))); break;
+                case Node::Op::Tan: if (arity == 1) return Node::createNode(std::tan(getValue(node->children[0]))); break;
+                case Node::Op::Sqrt: if (arity == 1) return Node::createNode(std::sqrt(getValue(node->children[0]))); break;
+                case Node::Op::Log: if (arity == 1) return Node::createNode(std::log10(getValue(node->children[0]))); break;
+                case Node::Op::Ln: if (arity == 1) return Node::createNode(std::log(getValue(node->children[0]))); break;
+                case Node::Op::Abs: if (arity == 1) return Node::createNode(std::abs(getValue(node->children[0]))); break;
+                case Node::Op::Atan2: if (arity == 2) return Node::createNode(std::atan2(getValue(node->children[0]), getValue(node->children[1]))); break;
+                default: break;
             }
-            if (op == "-" && node->children.size() == 1) {
-                return Node::createNode(-getValue(node->children[0]));
-            }
-            if (op == "!" && node->children.size() == 1) {
-                return Node::createNode(factorial(getValue(node->children[0])));
-            }
-
-            // Functions
-            if (op == "sin" && node->children.size() == 1) return Node::createNode(std::sin(getValue(node->children[0])));
-            if (op == "cos" && node->children.size() == 1) return Node::createNode(std::cos(getValue(node->children[0])));
-            if (op == "tan" && node->children.size() == 1) return Node::createNode(std::tan(getValue(node->children[0])));
-            if (op == "sqrt" && node->children.size() == 1) return Node::createNode(std::sqrt(getValue(node->children[0])));
-            if (op == "log" && node->children.size() == 1) return Node::createNode(std::log10(getValue(node->children[0])));
-            if (op == "ln" && node->children.size() == 1) return Node::createNode(std::log(getValue(node->children[0])));
-            if (op == "abs" && node->children.size() == 1) return Node::createNode(std::abs(getValue(node->children[0])));
-            if (op == "atan2" && node->children.size() == 2) return Node::createNode(std::atan2(getValue(node->children[0]), getValue(node->children[1])));
 
         } catch (const std::exception& _) {
             return node;
@@ -360,24 +398,24 @@ std::shared_ptr<Node> Simplifier::constantFoldNode(std::shared_ptr<Node> node) {
     return node;
 }
 
-std::shared_ptr<Node> Simplifier::simplifyPower(const std::shared_ptr<Node>& node) { // NOLINT(*-no-recursion)
+NodePtr Simplifier::simplifyPower(const NodePtr& node) { // NOLINT(*-no-recursion)
     auto& base = node->children[0];
     auto& exponent = node->children[1];
 
     //(a * b)^n -> (a^n) * (b^n)
-    if (base->type == Node::Type::Operand && base->value == "*") {
+    if (base->op == Node::Op::Mul) {
         auto& a = base->children[0];
         auto& b = base->children[1];
 
-        auto newLeft = std::make_shared<Node>(Node::Type::Operand, "^");
+        auto newLeft = makeNode(Node::Type::Operand, "^");
         newLeft->children.push_back(a);
         newLeft->children.push_back(exponent);
 
-        auto newRight = std::make_shared<Node>(Node::Type::Operand, "^");
+        auto newRight = makeNode(Node::Type::Operand, "^");
         newRight->children.push_back(b);
         newRight->children.push_back(exponent);
 
-        auto newProduct = std::make_shared<Node>(Node::Type::Operand, "*");
+        auto newProduct = makeNode(Node::Type::Operand, "*");
         newProduct->children.push_back(newLeft);
         newProduct->children.push_back(newRight);
 
@@ -385,19 +423,19 @@ std::shared_ptr<Node> Simplifier::simplifyPower(const std::shared_ptr<Node>& nod
     }
 
     // (a / b)^n  ->  (a^n) / (b^n)
-    if (base->type == Node::Type::Operand && base->value == "/") {
+    if (base->op == Node::Op::Div) {
         auto& a = base->children[0];
         auto& b = base->children[1];
 
-        auto newNum = std::make_shared<Node>(Node::Type::Operand, "^");
+        auto newNum = makeNode(Node::Type::Operand, "^");
         newNum->children.push_back(a);
         newNum->children.push_back(exponent);
 
-        auto newDen = std::make_shared<Node>(Node::Type::Operand, "^");
+        auto newDen = makeNode(Node::Type::Operand, "^");
         newDen->children.push_back(b);
         newDen->children.push_back(exponent);
 
-        auto newDivision = std::make_shared<Node>(Node::Type::Operand, "/");
+        auto newDivision = makeNode(Node::Type::Operand, "/");
         newDivision->children.push_back(newNum);
         newDivision->children.push_back(newDen);
 
@@ -405,15 +443,15 @@ std::shared_ptr<Node> Simplifier::simplifyPower(const std::shared_ptr<Node>& nod
     }
 
     // (a^m)^n -> a^(m*n)
-    if (base->type == Node::Type::Operand && base->value == "^") {
+    if (base->op == Node::Op::Pow) {
         auto& a = base->children[0];
         auto& m = base->children[1];
 
-        auto newExponent = std::make_shared<Node>(Node::Type::Operand, "*");
+        auto newExponent = makeNode(Node::Type::Operand, "*");
         newExponent->children.push_back(m);
         newExponent->children.push_back(exponent);
 
-        auto newPower = std::make_shared<Node>(Node::Type::Operand, "^");
+        auto newPower = makeNode(Node::Type::Operand, "^");
         newPower->children.push_back(a);
         newPower->children.push_back(newExponent);
 
@@ -422,13 +460,23 @@ std::shared_ptr<Node> Simplifier::simplifyPower(const std::shared_ptr<Node>& nod
 
     return node;
 }
-std::shared_ptr<Node> Simplifier::simplifyNode(std::shared_ptr<Node> node) { // NOLINT(*-no-recursion)
+NodePtr Simplifier::simplifyNode(NodePtr node) { // NOLINT(*-no-recursion)
     if (!node) {
         return nullptr;
     }
 
-    for (auto& child : node->children) {
-        child = simplifyNode(child);
+    // The node may be shared, so it is copied only when one of its children changed. A child that simplifies to an
+    // equal tree is kept as it was, so unchanged subtrees stay shared with the input.
+    Node::Children children;
+    bool changed = false;
+    for (const auto& child : node->children) {
+        NodePtr simplified = simplifyNode(child);
+        if (simplified != child && Node::equal(simplified.get(), child.get())) simplified = child;
+        changed |= simplified != child;
+        children.push_back(std::move(simplified));
+    }
+    if (changed) {
+        node = node->withChildren(std::move(children));
     }
 
     if (node->type != Node::Type::Operand && node->type != Node::Type::Function) {
@@ -442,23 +490,22 @@ std::shared_ptr<Node> Simplifier::simplifyNode(std::shared_ptr<Node> node) { //
     if (node->children.size() == 2) {
         auto& lhs = node->children[0];
         auto& rhs = node->children[1];
-        const std::string& op = node->value;
-        if (op == "/") {
-            if (rhs->value == "inf") return Node::createNode(0.0f);
+        if (node->op == Node::Op::Div) {
+            if (isNumber(rhs) && getValue(rhs) == INFINITY) return Node::createNode(0.0f);
             if (isNumber(lhs) && getValue(lhs) == 0.0) return Node::createNode(0.0f);
         }
     }
 
     // 3. --- DISPATCHER ---
-    if (node->type == Node::Type::Operand && (node->value == "+" || node->value == "-")) {
+    if (node->op == Node::Op::Add || node->op == Node::Op::Sub || node->op == Node::Op::Neg) {
         node = std::move(simplifySum(node));
     }
 
-    if (node->type == Node::Type::Operand && (node->value == "*" || node->value == "/")) {
+    if (node->op == Node::Op::Mul || node->op == Node::Op::Div) {
         node = std::move(simplifyProduct(node));
     }
 
-    if (node->type == Node::Type::Operand && node->value == "^") {
+    if (node->op == Node::Op::Pow) {
         node = std::move(simplifyPower(node));
     }
 
@@ -466,9 +513,9 @@ std::shared_ptr<Node> Simplifier::simplifyNode(std::shared_ptr<Node> node) { //
     if (node->children.size() == 2) {
         auto& lhs = node->children[0];
         auto& rhs = node->children[1];
-        const std::string& op = node->value;
+        const Node::Op op = node->op;
 
-        if (op == "*") {
+        if (op == Node::Op::Mul) {
             // x * 1 -> x
             if (isNumber(rhs) && getValue(rhs) == 1.0) return lhs;
             // 1 * x -> x
@@ -477,11 +524,11 @@ std::shared_ptr<Node> Simplifier::simplifyNode(std::shared_ptr<Node> node) { //
             if ((isNumber(rhs) && getValue(rhs) == 0.0) || (isNumber(lhs) && getValue(lhs) == 0.0))
                 return Node::createNode(0.0);
         }
-        else if (op == "/") {
-            if (rhs->value == "inf") return Node::createNode(0.0f);
+        else if (op == Node::Op::Div) {
+            if (isNumber(rhs) && getValue(rhs) == INFINITY) return Node::createNode(0.0f);
             if (isNumber(lhs) && getValue(lhs) == 0.0) return Node::createNode(0.0f);
         }
-        else if (op == "+") {
+        else if (op == Node::Op::Add) {
             // x + 0 -> x
             if (isNumber(rhs) && getValue(rhs) == 0.0) return lhs;
             // 0 + x -> x
@@ -489,26 +536,20 @@ std::shared_ptr<Node> Simplifier::simplifyNode(std::shared_ptr<Node> node) { //
 
             // -1 + x -> x - 1
             if (isNumber(lhs) && getValue(lhs) < 0.0) {
-                node->value = '-';
-                auto const ch = node->children[0];
-                ch->value = takeNegative(ch->value);
-                node->children[0] = std::move(node->children[1]);
-                node->children[1] = ch;
+                auto difference = makeNode(Node::Type::Operand, "-");
+                difference->children.push_back(rhs);
+                difference->children.push_back(Node::createNode(-getValue(lhs)));
+                return difference;
             }
         }
-        else if (op == "-") {
+        else if (op == Node::Op::Sub) {
             // x - 0 -> x
             if (isNumber(rhs) && getValue(rhs) == 0.0) return lhs;
             // 0 - x -> -x
-            if (isNumber(lhs) && getValue(lhs) == 0.0) {
-                auto minus = Node::createNode(Token(Token::Type::Symbol,"-"));
-                minus->children.push_back(rhs);
-                rhs = std::move(minus);
-                return rhs;
-            }
+            if (isNumber(lhs) && getValue(lhs) == 0.0) return Node::createNegation(rhs);
 
         }
-        else if (op == "^") {
+        else if (op == Node::Op::Pow) {
             // x ^ 1 -> x
             if (isNumber(rhs) && getValue(rhs) == 1.0) return lhs;
             // x ^ 0 -> 1
@@ -521,10 +562,10 @@ std::shared_ptr<Node> Simplifier::simplifyNode(std::shared_ptr<Node> node) { //
     return node;
 }
 
-std::shared_ptr<Node> Simplifier::simplify(const std::shared_ptr<Node>& node) {
+NodePtr Simplifier::simplify(const NodePtr& node) {
     if (!node) {
         return nullptr;
     }
-    auto clonedNode = node->clone();
-    return simplifyNode(clonedNode);
+    NodePtr simplified = simplifyNode(node);
+    return Node::equal(simplified.get(), node.get()) ? node : simplified;
 }
@@ -11,16 +11,34 @@
 
 class SymbolicEvaluator {
 public:
-    std::shared_ptr<Node> expand(const std::shared_ptr<Node>& node);
+    NodePtr expand(const NodePtr& node);
     void clearVariable(const std::string& name);
-    void registerFunction(const std::shared_ptr<Node>& funcDefNode);
+    void registerFunction(const NodePtr& funcDefNode);
     void registerVariable(std::pair<std::string, double> var);
+    [[nodiscard]] const SymbolMap<ConstNodePtr>& getFunctions() const;
 
 private:
-    std::shared_ptr<Node> expandNode(const std::shared_ptr<Node>& node);
+    NodePtr expandNode(const NodePtr& node);
 
-    static std::shared_ptr<Node> substituteParameters(const std::shared_ptr<Node>& body, const std::vector<std::shared_ptr<Node>>& arguments);
+    static NodePtr substituteParameters(const NodePtr& body, const Node::Children& arguments);
 
-    std::unordered_map<std::string, std::shared_ptr<const Node>> functions;
-    std::unordered_map<std::string, double> variables;
+    SymbolMap<ConstNodePtr> functions;
+    SymbolMap<double> variables;
+
+    /* Expanded derivatives keyed by the expanded expression, which already reflects every substituted function and
+       variable, so entries never go stale. Expressions are found by structural hash and confirmed with Node::equal. */
+    struct DerivativeKey {
+        ConstNodePtr expression;
+        SymbolId variable;
+        bool operator==(const DerivativeKey& other) const {
+            return variable == other.variable && Node::equal(expression.get(), other.expression.get());
+        }
+    };
+    struct DerivativeKeyHash {
+        size_t operator()(const DerivativeKey& key) const {
+            return (key.expression ? key.expression->getHash() : 0) ^ (static_cast<size_t>(key.variable) * 31);
+        }
+    };
+    static constexpr size_t maxCachedDerivatives = 1024;
+    std::unordered_map<DerivativeKey, NodePtr, DerivativeKeyHash> derivatives;
 };
\ No newline at end of file
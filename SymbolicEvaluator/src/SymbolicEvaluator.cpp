@@ -8,100 +8,107 @@
 #include "../../Util/inc/ASTUtil.hpp"
 #include "../../Simplifier/inc/Simplifier.hpp"
 
-void SymbolicEvaluator::registerFunction(const std::shared_ptr<Node>& funcDefNode) {
+void SymbolicEvaluator::registerFunction(const NodePtr& funcDefNode) {
     if (funcDefNode->type == Node::Type::FunctionAssignment) {
-        functions[funcDefNode->value] = funcDefNode;
+        functions[funcDefNode->symbol] = funcDefNode;
     }
 }
 
 void SymbolicEvaluator::clearVariable(const std::string& name) {
-    auto it = variables.find(name);
-    if (it != variables.end()) {
-        variables.erase(it);
-    }
+    variables.erase(SymbolTable::intern(name));
 }
 
 void SymbolicEvaluator::registerVariable(std::pair<std::string, double> var) {
-    variables.emplace(var);
+    variables.insert(SymbolTable::intern(var.first), var.second);
+}
+
+const SymbolMap<ConstNodePtr>& SymbolicEvaluator::getFunctions() const {
+    return functions;
 }
 
-std::shared_ptr<Node> SymbolicEvaluator::expand(const std::shared_ptr<Node>& node) {
+NodePtr SymbolicEvaluator::expand(const NodePtr& node) {
     if (!node) {
         return nullptr;
     }
-    return expandNode(node);
+    auto expandedNode = expandNode(node);
+    // expandNode hands back its input when nothing changed, the result is still simplified and owned by the caller
+    return expandedNode == node ? Simplifier::simplify(node) : expandedNode;
 }
 
-std::shared_ptr<Node> SymbolicEvaluator::expandNode(const std::shared_ptr<Node>& node) { // NOLINT(*-no-recursion)
+// Returns the node itself when no function, variable or derivative below it changed, otherwise a new tree
+NodePtr SymbolicEvaluator::expandNode(const NodePtr& node) { // NOLINT(*-no-recursion)
     if (!node) {
         return nullptr;
     }
 
-    auto expandedNode = node->clone();
-    for (auto& child : expandedNode->children) {
-        child = expandNode(child);
+    auto children = node->children;
+    bool changed = false;
+    for (auto& child : children) {
+        auto expandedChild = expandNode(child);
+        changed |= expandedChild != child;
+        child = std::move(expandedChild);
     }
 
-    if (expandedNode->type == Node::Type::Function) {
-        auto it = functions.find(expandedNode->value);
-
-        if (it != functions.end()) {
-            auto funcDefNode = it->second;
-            auto funcBody = funcDefNode->children[0];
-            const auto& arguments = expandedNode->children;
-            auto clonedBody = funcBody->clone();
-            auto substitutedBody = substituteParameters(clonedBody, arguments);
-            return expandNode(substitutedBody);
+    if (node->type == Node::Type::Function) {
+        if (const ConstNodePtr* definition = functions.find(node->symbol)) {
+            auto funcBody = (*definition)->children[0];
+            auto substitutedBody = substituteParameters(funcBody, children);
+            auto expandedBody = expandNode(substitutedBody);
+            // The substituted body shares nodes with the definition and the arguments
+            return expandedBody == substitutedBody ? Simplifier::simplify(substitutedBody) : expandedBody;
         }
     }
-    else if (expandedNode->type == Node::Type::Variable) {
-        auto it = variables.find(expandedNode->value);
-        if (it != variables.end()) {
-            auto variable = it->second;
-            expandedNode->value = std::to_string(variable);
-            expandedNode->type = Node::Type::Number;
-        }
-        if (node->value == "pi") {
-            expandedNode->value = std::to_string(M_PI);
-            expandedNode->type = Node::Type::Number;
-        }
-        if (node->value == "e") {
-            expandedNode->value = std::to_string(M_E);
-            expandedNode->type = Node::Type::Number;
-        }
+    else if (node->type == Node::Type::Variable) {
+        if (node->op == Node::Op::Pi) return Node::createNode(M_PI);
+        if (node->op == Node::Op::E) return Node::createNode(M_E);
+        if (const double* value = variables.find(node->symbol)) return Node::createNode(*value);
     }
-    else if (expandedNode->type == Node::Type::Derivative){
-        auto expanded_child = expandNode(node->children[0]);
-        auto differentiated_node = differentiate(expanded_child, node->value);
-        return expandNode(differentiated_node);
+    else if (node->type == Node::Type::Derivative){
+        auto expanded_child = children[0];
+        if (expanded_child == node->children[0]) expanded_child = Simplifier::simplify(expanded_child);
+        DerivativeKey key{expanded_child, node->symbol};
+        auto it = derivatives.find(key);
+        if (it == derivatives.end()) {
+            auto differentiated_node = differentiate(expanded_child, node->name());
+            auto result = expand(differentiated_node);
+            if (derivatives.size() >= maxCachedDerivatives) derivatives.clear();
+            it = derivatives.emplace(std::move(key), std::move(result)).first;
+        }
+        return it->second; /* Shared with every later hit, nodes are not changed in place once shared */
     }
 
-    return Simplifier::simplify(expandedNode);
+    if (!changed) return node;
+    return Simplifier::simplify(node->withChildren(std::move(children)));
 }
 
 
-std::shared_ptr<Node> SymbolicEvaluator::substituteParameters(const std::shared_ptr<Node>& body, const std::vector<std::shared_ptr<Node>>& arguments) { // NOLINT(*-no-recursion)
+// Copies only the path from the body root to each parameter, everything else is shared with the body
+NodePtr SymbolicEvaluator::substituteParameters(const NodePtr& body, const Node::Children& arguments) { // NOLINT(*-no-recursion)
     if (!body) {
         return nullptr;
     }
 
     if (body->type == Node::Type::Parameter) {
-        size_t separator_pos = body->value.find('-');
+        size_t separator_pos = body->name().find('-');
         if (separator_pos == std::string::npos) {
-            throw std::runtime_error("Invalid parameter format: " + body->value);
+            throw std::runtime_error("Invalid parameter format: " + body->name());
         }
-        int index = std::stoi(body->value.substr(0, separator_pos));
+        const size_t index = std::stoul(body->name().substr(0, separator_pos));
 
         if (index >= arguments.size()) {
             throw std::runtime_error("Function argument index out of bounds.");
         }
 
-        return arguments[index]->clone();
+        return arguments[index];
     }
 
-    for (auto& child : body->children) {
-        child = substituteParameters(child, arguments);
+    Node::Children children;
+    for (size_t i = 0; i < body->children.size(); ++i) {
+        auto child = substituteParameters(body->children[i], arguments);
+        if (child == body->children[i] && children.empty()) continue;
+        if (children.empty()) children.assign(body->children.begin(), body->children.begin() + static_cast<std::ptrdiff_t>(i));
+        children.push_back(std::move(child));
     }
 
-    return body;
+    return children.empty() ? body : body->withChildren(std::move(children));
 }
@@ -0,0 +1,85 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using SymbolId = uint32_t;
+
+/*
+ * Process-wide table of interned names. A name gets its id the first time it is seen and keeps it until the process
+ * exits, so tokens and nodes carry the id and compare names without touching the string. Safe to use from any thread.
+ * Names from input are bounded by inputNameLimit and inputByteLimit, since a long running server would otherwise keep
+ * every identifier a client ever sent.
+ */
+class SymbolTable {
+public:
+    static constexpr SymbolId empty = 0; /* Id of the empty name carried by Number nodes */
+    static constexpr size_t inputNameLimit = size_t(1) << 20;
+    static constexpr size_t inputByteLimit = size_t(64) << 20;
+
+    /* For names the engine makes itself, these may go past the input limits */
+    static SymbolId intern(std::string_view name);
+
+    /* For names read from input; nullopt for a new name once the table holds more than the input limits allow */
+    static std::optional<SymbolId> tryIntern(std::string_view name);
+
+    /* Lock free, the id must come from intern */
+    static const std::string &name(SymbolId id);
+};
+
+/* Values keyed by symbol id, stored in a vector indexed by the id */
+template<typename T>
+class SymbolMap {
+    std::vector<std::optional<T>> slots;
+    size_t count = 0;
+
+public:
+    SymbolMap() = default;
+
+    /* Interns the names of the entries */
+    SymbolMap(std::initializer_list<std::pair<std::string_view, T>> entries) {
+        for (const auto &[name, value]: entries) insert(SymbolTable::intern(name), value);
+    }
+
+    [[nodiscard]] bool contains(SymbolId id) const { return id < slots.size() && slots[id].has_value(); }
+    [[nodiscard]] T *find(SymbolId id) { return contains(id) ? &*slots[id] : nullptr; }
+    [[nodiscard]] const T *find(SymbolId id) const { return contains(id) ? &*slots[id] : nullptr; }
+    [[nodiscard]] size_t size() const { return count; }
+
+    /* Returns false and leaves the map unchanged if the id already has a value */
+    bool insert(SymbolId id, T value) {
+        if (contains(id)) return false;
+        (*this)[id] = std::move(value);
+        return true;
+    }
+
+    T &operator[](SymbolId id) {
+        if (id >= slots.size()) slots.resize(id + 1);
+        if (!slots[id]) {
+            slots[id].emplace();
+            count++;
+        }
+        return *slots[id];
+    }
+
+    void erase(SymbolId id) {
+        if (!contains(id)) return;
+        slots[id].reset();
+        count--;
+    }
+
+    /* Calls fun(id, value) for every entry in id order */
+    template<typename Func>
+    void forEach(Func fun) const {
+        for (SymbolId id = 0; id < slots.size(); ++id)
+            if (slots[id]) fun(id, *slots[id]);
+    }
+};
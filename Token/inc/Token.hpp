@@ -4,18 +4,35 @@
 
 #pragma once
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include "SymbolTable.hpp"
+
+/* Lexer input together with the offsets at which each line starts. Tokens point into it. */
+struct Source {
+    std::string text;
+    std::vector<size_t> lineStarts;
+    int firstLine;
+
+    explicit Source(std::string text, int firstLine = 1);
+    [[nodiscard]] std::string_view getLine(int line) const;
+};
 
 struct Token {
     enum class Type { Number, Symbol, Word, Skip, Newline, Eof, Comma, Derivative};
 
     Type type;
-    std::string value;
+    SymbolId symbol; /* Interned value of Word and Symbol tokens, empty for the others */
+    std::string_view value;
     int line;
     int pos;
-    std::string line_content;
+    const Source *source;
+    double number = 0.0; /* Parsed value of Number tokens */
 
-    Token(const Type &type, const std::string &value, int line, int pos, const std::string &line_content);
-    Token(const Type &type, const std::string &value);
+    Token(const Type &type, std::string_view value, int line, int pos, const Source *source);
+    Token(const Type &type, std::string_view value);
+    [[nodiscard]] std::string_view getLineContent() const;
     static bool isTokenPostFix(const Token &token);
     static bool isTokenPreFix(const Token &token);
     static bool isNewline(const Token &token);
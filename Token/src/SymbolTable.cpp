@@ -0,0 +1,81 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include "../inc/SymbolTable.hpp"
+
+#include <bit>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+/*
+ * Names live in chunks that double in size and are never moved or freed, so name() can index them without a lock.
+ * Chunk k holds firstChunkSize << k names and starts at id firstChunkSize * (2^k - 1).
+ */
+static constexpr size_t firstChunkSize = 256;
+static constexpr size_t chunkCount = 24;
+
+struct Table {
+    std::shared_mutex mutex;
+    std::unordered_map<std::string_view, SymbolId> ids; /* Keys view the names stored in the chunks */
+    std::string *chunks[chunkCount] = {};
+    SymbolId size = 0;
+    size_t bytes = 0;
+
+    static std::pair<size_t, size_t> locate(SymbolId id) {
+        const size_t chunk = std::bit_width(id / firstChunkSize + 1) - 1;
+        return {chunk, id - firstChunkSize * ((size_t(1) << chunk) - 1)};
+    }
+
+    SymbolId add(std::string_view name) {
+        auto [chunk, offset] = locate(size);
+        if (chunk >= chunkCount) throw std::length_error("Symbol table is full.");
+        if (!chunks[chunk]) chunks[chunk] = new std::string[firstChunkSize << chunk];
+        std::string &stored = chunks[chunk][offset];
+        stored = name;
+        bytes += name.size();
+        ids.emplace(stored, size);
+        return size++;
+    }
+
+    Table() { add(""); }
+};
+
+static Table &getTable() {
+    static Table table;
+    return table;
+}
+
+SymbolId SymbolTable::intern(std::string_view name) {
+    Table &table = getTable();
+    {
+        std::shared_lock lock(table.mutex);
+        auto it = table.ids.find(name);
+        if (it != table.ids.end()) return it->second;
+    }
+    std::unique_lock lock(table.mutex);
+    auto it = table.ids.find(name);
+    if (it != table.ids.end()) return it->second;
+    return table.add(name);
+}
+
+std::optional<SymbolId> SymbolTable::tryIntern(std::string_view name) {
+    Table &table = getTable();
+    {
+        std::shared_lock lock(table.mutex);
+        auto it = table.ids.find(name);
+        if (it != table.ids.end()) return it->second;
+    }
+    std::unique_lock lock(table.mutex);
+    auto it = table.ids.find(name);
+    if (it != table.ids.end()) return it->second;
+    if (table.size >= inputNameLimit || table.bytes + name.size() > inputByteLimit) return std::nullopt;
+    return table.add(name);
+}
+
+const std::string &SymbolTable::name(SymbolId id) {
+    auto [chunk, offset] = Table::locate(id);
+    return getTable().chunks[chunk][offset];
+}
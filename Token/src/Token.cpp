@@ -4,15 +4,41 @@
 
 #include "../inc/Token.hpp"
 #include <sstream>
+#include <utility>
 
 using Type = Token::Type;
 
-Token::Token(const Type &type, const std::string &value, int line, int pos, const std::string &line_content)
-    : type(type), value(value), line(line), pos(pos), line_content(line_content) {
+Source::Source(std::string text, int firstLine) : text(std::move(text)), lineStarts{0}, firstLine(firstLine) {
+    for (size_t i = 0; i < this->text.length(); ++i) {
+        if (this->text[i] == '\n') lineStarts.push_back(i + 1);
+    }
+}
+
+std::string_view Source::getLine(int line) const {
+    line -= firstLine - 1;
+    if (line < 1 || line > static_cast<int>(lineStarts.size())) return {};
+    const size_t begin = lineStarts[line - 1];
+    const size_t end = line < static_cast<int>(lineStarts.size()) ? lineStarts[line] - 1 : text.length();
+    return std::string_view(text).substr(begin, end - begin);
+}
+
+/* Words and operators are interned as they are scanned, so names are compared by id from here on.
+   A word the full table turns away gets the empty id, which the Lexer reports. */
+static SymbolId internValue(Type type, std::string_view value) {
+    if (type == Type::Word) return SymbolTable::tryIntern(value).value_or(SymbolTable::empty);
+    return type == Type::Symbol ? SymbolTable::intern(value) : SymbolTable::empty;
+}
+
+Token::Token(const Type &type, std::string_view value, int line, int pos, const Source *source)
+    : type(type), symbol(internValue(type, value)), value(value), line(line), pos(pos), source(source) {
+}
+
+Token::Token(const Type &type, std::string_view value)
+    : type(type), symbol(internValue(type, value)), value(value), line(0), pos(0), source(nullptr) {
 }
 
-Token::Token(const Type &type, const std::string &value)
-    : type(type), value(value), line(0), pos(0){
+std::string_view Token::getLineContent() const {
+    return source ? source->getLine(line) : std::string_view{};
 }
 
 std::ostream &operator<<(std::ostream &os, const Token &token) {
@@ -7,66 +7,88 @@
 #include <memory>
 #include <sstream>
 #include <map>
+#include <charconv>
 #include "../../Node/inc/Node.hpp"
+#include "../../Node/inc/FlatTree.hpp"
 
-static void toLispImpl(const Node* n, std::ostringstream& out) {
-    if (!n) {
+/* Significant digits of numbers in human readable output, toLisp prints the shortest exact form */
+static constexpr int displayPrecision = 12;
+
+static std::string formatNumber(double value, int precision = 0) {
+    char buffer[32];
+    auto result = precision > 0
+        ? std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, precision)
+        : std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return {buffer, result.ptr};
+}
+
+/* Node access used by the printers, overloaded so they print Node trees and FlatTrees alike */
+static bool isNull(const Node* n) { return !n; }
+static Node::Type nodeType(const Node* n) { return n->type; }
+static Node::Op nodeOp(const Node* n) { return n->op; }
+static const std::string& nodeValue(const Node* n) { return n->name(); }
+static double nodeNumber(const Node* n) { return n->number; }
+static size_t childCount(const Node* n) { return n->children.size(); }
+static const Node* childAt(const Node* n, size_t i) { return n->children[i].get(); }
+
+static bool isNull(FlatTree::Ref n) { return n.index == FlatTree::null; }
+static Node::Type nodeType(FlatTree::Ref n) { return (*n.tree)[n.index].type; }
+static Node::Op nodeOp(FlatTree::Ref n) { return (*n.tree)[n.index].op; }
+static const std::string& nodeValue(FlatTree::Ref n) { return n.tree->name(n.index); }
+static double nodeNumber(FlatTree::Ref n) { return (*n.tree)[n.index].number; }
+static size_t childCount(FlatTree::Ref n) { return (*n.tree)[n.index].childCount; }
+static FlatTree::Ref childAt(FlatTree::Ref n, size_t i) { return {n.tree, n.tree->child(n.index, i)}; }
+
+template<typename NodeRef>
+static void toLispImpl(NodeRef n, std::ostringstream& out) {
+    if (isNull(n)) {
         out << "<null>";
         return;
     }
 
-    switch (n->type) {
-        case Node::Type::Number: {
-            std::string s = n->value;
-            size_t dot_pos = s.find('.');
-            if (dot_pos != std::string::npos) {
-                s.erase(n->value.find_last_not_of('0') + 1, std::string::npos);
-                if (s.back() == '.') {
-                    s.pop_back();
-                }
-            }
-            out << s;
-        }
+    switch (nodeType(n)) {
+        case Node::Type::Number:
+            out << formatNumber(nodeNumber(n));
             break;
         case Node::Type::Variable:
-            out << n->value;
+            out << nodeValue(n);
             break;
         case Node::Type::Parameter: {
-            size_t separator_pos = n->value.find('-');
+            size_t separator_pos = nodeValue(n).find('-');
             if (separator_pos != std::string::npos) {
-                out << n->value.substr(separator_pos + 1);
+                out << nodeValue(n).substr(separator_pos + 1);
             } else {
-                out << n->value;
+                out << nodeValue(n);
             }
             break;
         }
         case Node::Type::Assignment:
-            out << "(= " << n->value << " ";
-            toLispImpl(n->children[0].get(), out);
+            out << "(= " << nodeValue(n) << " ";
+            toLispImpl(childAt(n, 0), out);
             out << ")";
             break;
         case Node::Type::Operand:
-            if (n->value == "!" && !n->children.empty()) {
+            if (nodeOp(n) == Node::Op::Fact && childCount(n) != 0) {
                 out << "(! ";
-                toLispImpl(n->children[0].get(), out);
+                toLispImpl(childAt(n, 0), out);
                 out << ")";
             } else {
-                out << "(" << n->value;
-                for (size_t i = 0; i < n->children.size(); ++i) {
+                out << "(" << nodeValue(n);
+                for (size_t i = 0; i < childCount(n); ++i) {
                     out << " ";
-                    toLispImpl(n->children[i].get(), out);
+                    toLispImpl(childAt(n, i), out);
                 }
                 out << ")";
             }
             break;
         case Node::Type::Function:
         case Node::Type::FunctionAssignment:
-            out << "(" << n->value;
-            if (!n->children.empty()) {
+            out << "(" << nodeValue(n);
+            if (childCount(n) != 0) {
                 out << " ";
-                for (size_t i = 0; i < n->children.size(); ++i) {
+                for (size_t i = 0; i < childCount(n); ++i) {
                     if (i) out << " ";
-                    toLispImpl(n->children[i].get(), out);
+                    toLispImpl(childAt(n, i), out);
                 }
             }
             out << ")";
@@ -75,12 +97,18 @@ static void toLispImpl(const Node* n, std::ostringstream& out) {
     }
 }
 
-static std::string toLisp(const std::shared_ptr<Node>& n) {
+inline std::string toLisp(const NodePtr& n) {
     std::ostringstream out;
     toLispImpl(n.get(), out);
     return out.str();
 }
 
+inline std::string toLisp(const FlatTree& tree) {
+    std::ostringstream out;
+    toLispImpl(tree.root(), out);
+    return out.str();
+}
+
 
 enum Precedence {
     PREC_NONE = 0,
@@ -92,27 +120,27 @@ enum Precedence {
     PREC_ATOM = 6        // Numbers, variables
 };
 
-static int getOperatorPrecedence(const std::string& op) {
-    static const std::map<std::string, int> precMap = {
-        {"+", PREC_SUM},         {"-", PREC_SUM},
-        {"*", PREC_PRODUCT},     {"/", PREC_PRODUCT},
-        {"^", PREC_POWER}
-    };
-    auto it = precMap.find(op);
-    if (it != precMap.end()) {
-        return it->second;
+static int getOperatorPrecedence(Node::Op op) {
+    switch (op) {
+        case Node::Op::Add:
+        case Node::Op::Sub: return PREC_SUM;
+        case Node::Op::Mul:
+        case Node::Op::Div: return PREC_PRODUCT;
+        case Node::Op::Pow: return PREC_POWER;
+        default: return PREC_NONE;
     }
-    return PREC_NONE;
 }
 
-static bool isUnary(const Node* n) {
-    if (n->type != Node::Type::Operand) return false;
-    return (n->value == "!" || n->value == "-") && n->children.size() == 1;
+template<typename NodeRef>
+static bool isUnary(NodeRef n) {
+    if (nodeType(n) != Node::Type::Operand) return false;
+    return (nodeOp(n) == Node::Op::Fact || nodeOp(n) == Node::Op::Neg) && childCount(n) == 1;
 }
 
-static int getNodePrecedence(const Node* n) {
-    if (!n) return PREC_NONE;
-    switch (n->type) {
+template<typename NodeRef>
+static int getNodePrecedence(NodeRef n) {
+    if (isNull(n)) return PREC_NONE;
+    switch (nodeType(n)) {
         case Node::Type::Number:
         case Node::Type::Variable:
         case Node::Type::Parameter:
@@ -125,7 +153,7 @@ static int getNodePrecedence(const Node* n) {
             return PREC_NONE;
         case Node::Type::Operand:
             if (isUnary(n)) return PREC_UNARY;
-            return getOperatorPrecedence(n->value);
+            return getOperatorPrecedence(nodeOp(n));
         default:
             return PREC_NONE;
     }
@@ -134,64 +162,57 @@ static int getNodePrecedence(const Node* n) {
 // Checks if the node n (in the context of parentPrec) starts with a character
 // that is safe for implicit multiplication (like a letter or '(').
 // Returns false if it starts with a digit or operator sign.
-static bool isSafeForImplicit(const Node* n, int parentPrec) {
-    if (!n) return true;
+template<typename NodeRef>
+static bool isSafeForImplicit(NodeRef n, int parentPrec) {
+    if (isNull(n)) return true;
 
     // If precedence requires parentheses, it will start with '(', which is safe.
     int nPrec = getNodePrecedence(n);
     if (nPrec < parentPrec) return true;
 
     // If not parenthesized, check what it starts with.
-    if (n->type == Node::Type::Number) return false; // Starts with digit
+    if (nodeType(n) == Node::Type::Number) return false; // Starts with digit
 
-    if (n->type == Node::Type::Operand) {
+    if (nodeType(n) == Node::Type::Operand) {
         // Unary +, - start with sign.
-        if (n->value == "+" || n->value == "-") {
+        if (nodeOp(n) == Node::Op::Add || nodeOp(n) == Node::Op::Sub || nodeOp(n) == Node::Op::Neg) {
             // Unary or Binary start with sign or number
-            if (n->children.size() == 1) return false;
+            if (childCount(n) == 1) return false;
             // Binary: Check left child
-            return isSafeForImplicit(n->children[0].get(), nPrec + 1);
+            return isSafeForImplicit(childAt(n, 0), nPrec + 1);
         }
-        if (n->value == "!") {
+        if (nodeOp(n) == Node::Op::Fact) {
             // Postfix ! starts with child
-            return isSafeForImplicit(n->children[0].get(), nPrec);
+            return isSafeForImplicit(childAt(n, 0), nPrec);
         }
         // Binary *, /, ^ start with left child
-        int opPrec = getOperatorPrecedence(n->value);
-        return isSafeForImplicit(n->children[0].get(), opPrec + 1);
+        int opPrec = getOperatorPrecedence(nodeOp(n));
+        return isSafeForImplicit(childAt(n, 0), opPrec + 1);
     }
 
     return true; // Variables, Functions, etc. are safe
 }
 
-static void toHumanReadableImpl(const Node* n, std::ostringstream& out, int parentPrecedence) {
-    if (!n) {
+template<typename NodeRef>
+static void toHumanReadableImpl(NodeRef n, std::ostringstream& out, int parentPrecedence) {
+    if (isNull(n)) {
         out << "<null>";
         return;
     }
 
-    switch (n->type) {
-        case Node::Type::Number: {
-            std::string s = n->value;
-            size_t dot_pos = s.find('.');
-            if (dot_pos != std::string::npos) {
-                s.erase(n->value.find_last_not_of('0') + 1, std::string::npos);
-                if (s.back() == '.') {
-                    s.pop_back();
-                }
-            }
-            out << s;
-        }
+    switch (nodeType(n)) {
+        case Node::Type::Number:
+            out << formatNumber(nodeNumber(n), displayPrecision);
             break;
         case Node::Type::Variable:
-            out << n->value;
+            out << nodeValue(n);
             break;
         case Node::Type::Parameter: {
-            size_t separator_pos = n->value.find('-');
+            size_t separator_pos = nodeValue(n).find('-');
             if (separator_pos != std::string::npos) {
-                out << n->value.substr(separator_pos + 1);
+                out << nodeValue(n).substr(separator_pos + 1);
             } else {
-                out << n->value;
+                out << nodeValue(n);
             }
             break;
         }
@@ -199,58 +220,58 @@ static void toHumanReadableImpl(const Node* n, std::ostringstream& out, int pare
             int currentPrec = 0;
             if (currentPrec < parentPrecedence) out << "(";
 
-            out << n->value << " = ";
-            toHumanReadableImpl(n->children[0].get(), out, currentPrec);
+            out << nodeValue(n) << " = ";
+            toHumanReadableImpl(childAt(n, 0), out, currentPrec);
 
             if (currentPrec < parentPrecedence) out << ")";
             break;
         }
         case Node::Type::Operand: {
-            const std::string& op = n->value;
+            const std::string& op = nodeValue(n);
 
             if (isUnary(n)) {
                 int currentPrec = PREC_UNARY;
                 if (currentPrec < parentPrecedence) out << "(";
-                if (op == "!") {
-                    toHumanReadableImpl(n->children[0].get(), out, currentPrec);
+                if (nodeOp(n) == Node::Op::Fact) {
+                    toHumanReadableImpl(childAt(n, 0), out, currentPrec);
                     out << op;
                 }else {
                     out << op;
-                    toHumanReadableImpl(n->children[0].get(), out, currentPrec);
+                    toHumanReadableImpl(childAt(n, 0), out, currentPrec);
                 }
                 if (currentPrec < parentPrecedence) {
                     out << ")";
                 }
             }
             else {
-                int currentPrec = getOperatorPrecedence(op);
+                int currentPrec = getOperatorPrecedence(nodeOp(n));
                 if (currentPrec < parentPrecedence) out << "(";
-                toHumanReadableImpl(n->children[0].get(), out, currentPrec+1);
+                toHumanReadableImpl(childAt(n, 0), out, currentPrec+1);
 
-                for (size_t i = 1; i < n->children.size(); ++i) {
-                    if (op == "*") {
+                for (size_t i = 1; i < childCount(n); ++i) {
+                    if (nodeOp(n) == Node::Op::Mul) {
                         // Check if we can use implicit multiplication.
                         // We need explicit * if the right-hand side looks like a number or operator.
-                        if (!isSafeForImplicit(n->children[i].get(), currentPrec + 1)) {
+                        if (!isSafeForImplicit(childAt(n, i), currentPrec + 1)) {
                             out << "*";
                         }
                         // Else print nothing (implicit)
-                    } else if (op == "+" || op == "-") {
+                    } else if (nodeOp(n) == Node::Op::Add || nodeOp(n) == Node::Op::Sub) {
                         out << " " << op << " ";
                     } else {
                         out << op;
                     }
-                    toHumanReadableImpl(n->children[i].get(), out, currentPrec+1);
+                    toHumanReadableImpl(childAt(n, i), out, currentPrec+1);
                 }
                 if (currentPrec < parentPrecedence) out << ")";
             }
             break;
         }
         case Node::Type::Function: {
-            out << n->value << "(";
-            for (size_t i = 0; i < n->children.size(); ++i) {
+            out << nodeValue(n) << "(";
+            for (size_t i = 0; i < childCount(n); ++i) {
                 if (i > 0) out << ", ";
-                toHumanReadableImpl(n->children[i].get(), out, PREC_NONE);
+                toHumanReadableImpl(childAt(n, i), out, PREC_NONE);
             }
             out << ")";
             break;
@@ -259,15 +280,15 @@ static void toHumanReadableImpl(const Node* n, std::ostringstream& out, int pare
             int currentPrec = 0;
             if (currentPrec < parentPrecedence) out << "(";
 
-            out << n->value;
-            for (size_t i = 0; i < n->children.size() - 1; ++i) {
+            out << nodeValue(n);
+            for (size_t i = 0; i < childCount(n) - 1; ++i) {
                 if (i > 0) out << ", ";
-                toHumanReadableImpl(n->children[i].get(), out, PREC_NONE);
+                toHumanReadableImpl(childAt(n, i), out, PREC_NONE);
             }
             out << " = ";
 
-            if (!n->children.empty()) {
-                toHumanReadableImpl(n->children.back().get(), out, currentPrec);
+            if (childCount(n) != 0) {
+                toHumanReadableImpl(childAt(n, childCount(n) - 1), out, currentPrec);
             }
 
             if (currentPrec < parentPrecedence) out << ")";
@@ -278,8 +299,14 @@ static void toHumanReadableImpl(const Node* n, std::ostringstream& out, int pare
     }
 }
 
-static std::string toHumanReadable(const std::shared_ptr<Node>& n) {
+inline std::string toHumanReadable(const NodePtr& n) {
     std::ostringstream out;
     toHumanReadableImpl(n.get(), out, PREC_NONE);
     return out.str();
+}
+
+inline std::string toHumanReadable(const FlatTree& tree) {
+    std::ostringstream out;
+    toHumanReadableImpl(tree.root(), out, PREC_NONE);
+    return out.str();
 }
\ No newline at end of file
@@ -10,7 +10,6 @@
 #include "../../Node/inc/Node.hpp"
 
 double factorial(double n);
-std::string takeNegative(const std::string& value);
-bool isNumber(const std::shared_ptr<Node>& node);
-double getValue(const std::shared_ptr<Node>& node);
-std::shared_ptr<Node> differentiate(const std::shared_ptr<Node>& node, const std::string& var);
\ No newline at end of file
+bool isNumber(const NodePtr& node);
+double getValue(const NodePtr& node);
+NodePtr differentiate(const NodePtr& node, const std::string& var);
\ No newline at end of file
@@ -11,17 +11,13 @@
 #include "../../Simplifier/inc/Simplifier.hpp"
 
 
-bool isNumber(const std::shared_ptr<Node>& node) {
+bool isNumber(const NodePtr& node) {
     return node && node->type == Node::Type::Number;
 }
 
-double getValue(const std::shared_ptr<Node>& node) {
+double getValue(const NodePtr& node) {
     if (!isNumber(node)) return NAN;
-    try {
-        return std::stod(node->value);
-    } catch (const std::exception&) {
-        return NAN;
-    }
+    return node->number;
 }
 
 double factorial(double n) {
@@ -30,23 +26,19 @@ double factorial(double n) {
     return std::tgamma(n + 1);
 }
 
-std::string takeNegative(const std::string& value) {
-    return value[0] == '-' ? value.substr(1) : '-' + value;
-}
-
-static std::shared_ptr<Node> createNum(double val) {
+static NodePtr createNum(double val) {
     return Node::createNode(val);
 }
 
-static std::shared_ptr<Node> createOp(const std::string& op) {
-    return std::make_shared<Node>(Node::Type::Operand, op);
+static NodePtr createOp(const std::string& op) {
+    return makeNode(Node::Type::Operand, op);
 }
 
-static std::shared_ptr<Node> createFunc(const std::string& func) {
-    return std::make_shared<Node>(Node::Type::Function, func);
+static NodePtr createFunc(const std::string& func) {
+    return makeNode(Node::Type::Function, func);
 }
 
-std::shared_ptr<Node> differentiate(const std::shared_ptr<Node>& node, const std::string& var) {
+NodePtr differentiate(const NodePtr& node, const std::string& var) {
     if (!node) {
         return createNum(0);
     }
@@ -56,7 +48,7 @@ std::shared_ptr<Node> differentiate(const std::shared_ptr<Node>& node, const std
             return createNum(0);
 
         case Node::Type::Variable: {
-            if (node->value == var) {
+            if (node->name() == var) {
                 return createNum(1);
             } else {
                 return createNum(0);
@@ -64,8 +56,8 @@ std::shared_ptr<Node> differentiate(const std::shared_ptr<Node>& node, const std
         }
 
         case Node::Type::Parameter: {
-            size_t separator_pos = node->value.find('-');
-            std::string paramName = node->value.substr(separator_pos + 1);
+            size_t separator_pos = node->name().find('-');
+            std::string paramName = node->name().substr(separator_pos + 1);
             if (paramName == var) {
                 return createNum(1);
             } else {
@@ -74,15 +66,13 @@ std::shared_ptr<Node> differentiate(const std::shared_ptr<Node>& node, const std
         }
 
         case Node::Type::Operand: {
-            const std::string& op = node->value;
+            const Node::Op op = node->op;
             auto f = node->children[0];
 
             if (node->children.size() == 1) {
                 auto f_prime = differentiate(f, var);
-                if (op == "-") {
-                    auto minus = createOp("-");
-                    minus->children.push_back(f_prime);
-                    return Simplifier::simplify(minus);
+                if (op == Node::Op::Neg) {
+                    return Simplifier::simplify(Node::createNegation(f_prime));
                 }
                 return f_prime;
             }
@@ -91,14 +81,14 @@ std::shared_ptr<Node> differentiate(const std::shared_ptr<Node>& node, const std
             auto f_prime = differentiate(f, var);
             auto g_prime = differentiate(g, var);
 
-            if (op == "+" || op == "-") {
-                auto result = createOp(op);
+            if (op == Node::Op::Add || op == Node::Op::Sub) {
+                auto result = createOp(node->name());
                 result->children.push_back(f_prime);
                 result->children.push_back(g_prime);
                 return Simplifier::simplify(result);
             }
 
-            if (op == "*") {
+            if (op == Node::Op::Mul) {
                 auto mult1 = createOp("*");
                 mult1->children.push_back(f_prime);
                 mult1->children.push_back(g->clone());
@@ -113,7 +103,7 @@ std::shared_ptr<Node> differentiate(const std::shared_ptr<Node>& node, const std
                 return Simplifier::simplify(plus);
             }
 
-            if (op == "/") {
+            if (op == Node::Op::Div) {
                 auto mult1 = createOp("*");
                 mult1->children.push_back(f_prime);
                 mult1->children.push_back(g->clone());
@@ -136,7 +126,7 @@ std::shared_ptr<Node> differentiate(const std::shared_ptr<Node>& node, const std
                 return Simplifier::simplify(div);
             }
 
-            if (op == "^") {
+            if (op == Node::Op::Pow) {
                 if (isNumber(g)) {
                     double n = getValue(g);
 
@@ -186,52 +176,61 @@ std::shared_ptr<Node> differentiate(const std::shared_ptr<Node>& node, const std
             auto g = node->children[0];
             auto g_prime = differentiate(g, var);
 
-            std::shared_ptr<Node> outer_deriv = nullptr;
-            const std::string& func = node->value;
-
-            if (func == "sin") {
-                outer_deriv = createFunc("cos");
-                outer_deriv->children.push_back(g->clone());
-            } else if (func == "cos") {
-                auto sin_g = createFunc("sin");
-                sin_g->children.push_back(g->clone());
-                outer_deriv = createOp("-");
-                outer_deriv->children.push_back(sin_g);
-            } else if (func == "tan") {
-                auto cos_g = createFunc("cos");
-                cos_g->children.push_back(g->clone());
-                auto cos_g_sq = createOp("^");
-                cos_g_sq->children.push_back(cos_g);
-                cos_g_sq->children.push_back(createNum(2));
-                outer_deriv = createOp("/");
-                outer_deriv->children.push_back(createNum(1));
-                outer_deriv->children.push_back(cos_g_sq);
-            } else if (func == "ln") {
-                outer_deriv = createOp("/");
-                outer_deriv->children.push_back(createNum(1));
-                outer_deriv->children.push_back(g->clone());
-            } else if (func == "log") {
-                auto ln_10 = createFunc("ln");
-                ln_10->children.push_back(createNum(10));
-                auto den = createOp("*");
-                den->children.push_back(g->clone());
-                den->children.push_back(ln_10);
-                outer_deriv = createOp("/");
-                outer_deriv->children.push_back(createNum(1));
-                outer_deriv->children.push_back(den);
-            } else if (func == "sqrt") {
-                auto two_sqrt_g = createOp("*");
-                two_sqrt_g->children.push_back(createNum(2));
-                two_sqrt_g->children.push_back(node->clone());
-                outer_deriv = createOp("/");
-                outer_deriv->children.push_back(createNum(1));
-                outer_deriv->children.push_back(two_sqrt_g);
-            } else if (func == "abs") {
-                outer_deriv = createOp("/");
-                outer_deriv->children.push_back(g->clone());
-                outer_deriv->children.push_back(node->clone());
-            } else {
-                return createNum(0);
+            NodePtr outer_deriv = nullptr;
+            switch (node->op) {
+                case Node::Op::Sin:
+                    outer_deriv = createFunc("cos");
+                    outer_deriv->children.push_back(g->clone());
+                    break;
+                case Node::Op::Cos: {
+                    auto sin_g = createFunc("sin");
+                    sin_g->children.push_back(g->clone());
+                    outer_deriv = Node::createNegation(sin_g);
+                    break;
+                }
+                case Node::Op::Tan: {
+                    auto cos_g = createFunc("cos");
+                    cos_g->children.push_back(g->clone());
+                    auto cos_g_sq = createOp("^");
+                    cos_g_sq->children.push_back(cos_g);
+                    cos_g_sq->children.push_back(createNum(2));
+                    outer_deriv = createOp("/");
+                    outer_deriv->children.push_back(createNum(1));
+                    outer_deriv->children.push_back(cos_g_sq);
+                    break;
+                }
+                case Node::Op::Ln:
+                    outer_deriv = createOp("/");
+                    outer_deriv->children.push_back(createNum(1));
+                    outer_deriv->children.push_back(g->clone());
+                    break;
+                case Node::Op::Log: {
+                    auto ln_10 = createFunc("ln");
+                    ln_10->children.push_back(createNum(10));
+                    auto den = createOp("*");
+                    den->children.push_back(g->clone());
+                    den->children.push_back(ln_10);
+                    outer_deriv = createOp("/");
+                    outer_deriv->children.push_back(createNum(1));
+                    outer_deriv->children.push_back(den);
+                    break;
+                }
+                case Node::Op::Sqrt: {
+                    auto two_sqrt_g = createOp("*");
+                    two_sqrt_g->children.push_back(createNum(2));
+                    two_sqrt_g->children.push_back(node->clone());
+                    outer_deriv = createOp("/");
+                    outer_deriv->children.push_back(createNum(1));
+                    outer_deriv->children.push_back(two_sqrt_g);
+                    break;
+                }
+                case Node::Op::Abs:
+                    outer_deriv = createOp("/");
+                    outer_deriv->children.push_back(g->clone());
+                    outer_deriv->children.push_back(node->clone());
+                    break;
+                default:
+                    return createNum(0);
             }
 
             auto result = createOp("*");
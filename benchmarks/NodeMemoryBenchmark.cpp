@@ -0,0 +1,132 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <malloc.h>
+
+#include "Lexer/inc/Lexer.hpp"
+#include "Node/inc/FlatTree.hpp"
+#include "Parser/inc/Parser.hpp"
+
+/*
+ * Reports what parsed trees cost in memory: bytes and heap blocks per Node, and bytes per FlatTree entry.
+ * Bytes are the usable sizes malloc reports, without its per-block header.
+ * Usage: NodeMemoryBenchmark [statementCount]
+ */
+
+/* Every allocation of the process goes through these, so the live totals cover nodes, their spilled children and FlatTree tables */
+static size_t liveBlocks = 0;
+static size_t liveBytes = 0;
+
+void *operator new(size_t size) {
+    void *p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    liveBlocks++;
+    liveBytes += malloc_usable_size(p);
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    if (!p) return;
+    liveBlocks--;
+    liveBytes -= malloc_usable_size(p);
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+/* Appends a random expression with the operators, built-ins and user calls the parser produces nodes for */
+static void appendExpression(std::string &out, std::mt19937 &random, int depth) {
+    auto pick = [&](int n) { return static_cast<int>(random() % n); };
+    if (depth == 0 || pick(10) < 3) {
+        static const char *leaves[] = {"x", "y", "t", "pi", "2", "0.5", "3.25", "17"};
+        out += leaves[pick(8)];
+        return;
+    }
+    static const char *operators[] = {" + ", " - ", " * ", " / ", "^"};
+    static const char *functions[] = {"sin(", "cos(", "ln(", "sqrt(", "abs("};
+    switch (pick(6)) {
+        case 0: out += "-("; appendExpression(out, random, depth - 1); out += ")"; break;
+        case 1: out += "("; appendExpression(out, random, depth - 1); out += ")!"; break;
+        case 2: out += functions[pick(5)]; appendExpression(out, random, depth - 1); out += ")"; break;
+        case 3:
+            out += "atan2(";
+            appendExpression(out, random, depth - 1);
+            out += ", ";
+            appendExpression(out, random, depth - 1);
+            out += ")";
+            break;
+        case 4:
+            out += "g(";
+            for (int i = 0; i < 3; ++i) {
+                if (i > 0) out += ", ";
+                appendExpression(out, random, depth - 1);
+            }
+            out += ")";
+            break;
+        default:
+            out += "(";
+            appendExpression(out, random, depth - 1);
+            out += operators[pick(5)];
+            appendExpression(out, random, depth - 1);
+            out += ")";
+    }
+}
+
+static std::vector<NodePtr> parse(const std::string &input) {
+    Parser parser;
+    parser.setSimplify(false);
+    Lexer lexer(input);
+    auto statements = parser.parse(lexer, false, 1);
+    if (!lexer.getError().empty() || !parser.getError().empty()) {
+        std::fprintf(stderr, "%s%s\n", lexer.getError().c_str(), parser.getError().c_str());
+        std::exit(1);
+    }
+    return statements;
+}
+
+int main(int argc, char **argv) {
+    const int statementCount = argc > 1 ? std::atoi(argv[1]) : 200;
+    std::mt19937 random(42);
+    std::string input = "g(a, b, c) = a + b * c\n";
+    for (int i = 0; i < statementCount; ++i) {
+        appendExpression(input, random, 12);
+        input += "\n";
+    }
+
+    /* A first parse interns every name, so the measured one allocates nothing but the trees */
+    parse(input);
+
+    std::vector<NodePtr> statements;
+    statements.reserve(statementCount + 1);
+    size_t blocksBefore = liveBlocks, bytesBefore = liveBytes;
+    for (auto &statement: parse(input)) statements.push_back(std::move(statement));
+    const size_t nodeBlocks = liveBlocks - blocksBefore, nodeBytes = liveBytes - bytesBefore;
+
+    std::unordered_set<const Node *> nodes;
+    for (const auto &statement: statements) statement->apply([&](Node *node) { nodes.insert(node); });
+    const double nodeCount = static_cast<double>(nodes.size());
+
+    std::vector<FlatTree> trees;
+    trees.reserve(statements.size());
+    bytesBefore = liveBytes;
+    for (const auto &statement: statements) trees.push_back(FlatTree::fromNode(statement));
+    const size_t flatBytes = liveBytes - bytesBefore;
+
+    std::printf("statements        %zu\n", statements.size());
+    std::printf("nodes             %zu\n", nodes.size());
+    std::printf("sizeof(Node)      %zu bytes\n", sizeof(Node));
+    std::printf("Node trees        %.1f bytes per node, %.3f heap blocks per node\n", nodeBytes / nodeCount, nodeBlocks / nodeCount);
+    std::printf("FlatTree          %.1f bytes per node, including child indices\n", flatBytes / nodeCount);
+    return 0;
+}
@@ -1,94 +1,67 @@
 #include <iostream>
 #include <string>
-#include <vector>
-#include <memory>
 #include <fstream>
 #include <sstream>
+#include <mutex>
+#include <utility>
 
 #include "crow_all.h" // Ensure this is in your folder
 
-#include "Lexer/inc/Lexer.hpp"
 #include "Parser/inc/Parser.hpp"
+#include "Parser/inc/IncrementalParser.hpp"
 #include "Evaluator/inc/Evaluator.hpp"
 #include "SymbolicEvaluator/inc/SymbolicEvaluator.hpp"
 #include "Util/inc/ASTPrint.hpp"
+#include "Session/inc/Session.hpp"
 
-// We modify processInput to write to a stringstream instead of cout
-void processInput(const std::string& input, Parser& parser, Evaluator& evaluator, SymbolicEvaluator& sEvaluator, std::stringstream& out) {
-    if (input.empty()) return;
-
-    // --- NEW: Handle "clear x" ---
-    if (input.substr(0, 6) == "clear ") {
-        std::string varName = input.substr(6);
-        // Trim whitespace
-        varName.erase(0, varName.find_first_not_of(" \n\r\t"));
-        varName.erase(varName.find_last_not_of(" \n\r\t") + 1);
-
-        evaluator.clearVariable(varName);
-        sEvaluator.clearVariable(varName);
-        out << "Variable '" << varName << "' cleared.\n";
-        return;
-    }
-
-    Lexer lexer(input);
-    if (!lexer.getError().empty()) {
-        out << "Error: " << lexer.getError() << "\n";
-        return;
+int main(int argc, char* argv[]) {
+    // Persistent State
+    Parser parser;
+    Evaluator evaluator;
+    SymbolicEvaluator sEvaluator;
+    IncrementalParser incrementalParser;
+    // Crow handles requests on several threads, the engine state and its nodes are used by one request at a time
+    std::mutex stateMutex;
+
+    // --library <file> loads functions saved by an earlier session, --save-library <file> saves them on exit
+    // --verify-compiled checks every compiled result of a script against the tree walk and fails on a difference
+    std::string scriptPath, libraryPath, saveLibraryPath;
+    bool verifyCompiled = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if ((arg == "--library" || arg == "--save-library") && i + 1 < argc) {
+            (arg == "--library" ? libraryPath : saveLibraryPath) = argv[++i];
+        } else if (arg == "--verify-compiled") {
+            verifyCompiled = true;
+        } else {
+            scriptPath = arg;
+        }
     }
 
-    auto ast = parser.parse(lexer);
-    if (!parser.getError().empty()) {
-        out << "Error: " << parser.getError() << "\n";
-        parser.clearError();
-        return;
+    if (!libraryPath.empty() && !loadLibrary(libraryPath, parser, evaluator, sEvaluator, std::cerr)) {
+        return 1;
     }
 
-    for (const auto& node : ast) {
-        // --- CASE 1: DEFINITIONS (f(x) = ...) ---
-        if (node->type == Node::Type::FunctionAssignment) {
-            // 1. Expand symbolicly (resolve d/dx, simplify)
-            auto expandedNode = sEvaluator.expand(node);
-
-            // 2. Register Symbolic
-            sEvaluator.registerFunction(expandedNode);
-
-            // 3. Register Numeric (So we can plot it)
-            evaluator.evaluate(expandedNode);
-
-            out << "Defined: " << toHumanReadable(expandedNode) << "\n";
-            continue;
+    // Script mode: ./Math2.0 script.txt evaluates the file as a stream and exits
+    if (!scriptPath.empty()) {
+        std::ifstream script(scriptPath);
+        if (!script.is_open()) {
+            std::cerr << "Could not open " << scriptPath << std::endl;
+            return 1;
         }
-
-        // --- CASE 2: EXPRESSIONS (d/dx(x), 5+5, etc.) ---
-
-        // STEP 1: Always Expand First!
-        // This converts "d/dx(x)" -> "1" BEFORE we try to calculate it.
-        auto expandedNode = sEvaluator.expand(node);
-
-        // STEP 2: Try Numeric Evaluation on the expanded result
-        double val = evaluator.evaluate(expandedNode);
-        std::string evalError = evaluator.getError();
-
-        if (evalError.empty()) {
-            // Success: It's a number (e.g., 1, 10, 0.5)
-            if (node->type != Node::Type::Assignment) {
-                 out << val << "\n";
-            } else {
-                 // Variable Assignment: x = 5
-                 out << toHumanReadable(expandedNode) << " = " << val << "\n";
-            }
-        } else {
-            // Failure: It's likely purely symbolic (e.g., "x + y" where y is unknown)
-            // We just print the expanded symbolic form.
-            out << "--> " << toHumanReadable(expandedNode) << "\n";
+        evaluator.setVerifyCompiled(verifyCompiled);
+        processStream(script, parser, evaluator, sEvaluator, std::cout);
+        for (const auto& mismatch : evaluator.getCompiledMismatches()) {
+            std::cerr << "Mismatch (" << mismatch.backend << "): " << toHumanReadable(mismatch.statement)
+                      << " gave " << mismatch.actual << ", expected " << mismatch.expected << std::endl;
+        }
+        if (!evaluator.getCompiledMismatches().empty()) return 1;
+        if (!saveLibraryPath.empty() && !saveLibrary(saveLibraryPath, parser, sEvaluator)) {
+            std::cerr << "Could not write " << saveLibraryPath << std::endl;
+            return 1;
         }
+        return 0;
     }
-}
-int main(int argc, char* argv[]) {
-    // Persistent State
-    Parser parser;
-    Evaluator evaluator;
-    SymbolicEvaluator sEvaluator;
 
     crow::SimpleApp app;
 
@@ -111,9 +84,16 @@ int main(int argc, char* argv[]) {
         if (!x) return crow::response(400, "Invalid JSON");
 
         std::string code = x["code"].s();
+        const bool recover = x.has("recover") && x["recover"].b();
         std::stringstream outputBuffer;
+        std::lock_guard<std::mutex> lock(stateMutex);
+        parser.setSimplify(!x.has("simplify") || x["simplify"].b());
 
-        processInput(code, parser, evaluator, sEvaluator, outputBuffer);
+        if (x.has("cell")) {
+            processCell(static_cast<int>(x["cell"].i()), code, incrementalParser, parser, evaluator, sEvaluator, outputBuffer);
+        } else {
+            processInput(code, parser, evaluator, sEvaluator, outputBuffer, recover);
+        }
 
         crow::json::wvalue resp;
         resp["result"] = outputBuffer.str();
@@ -123,13 +103,20 @@ int main(int argc, char* argv[]) {
     // 3. Reset Memory
     CROW_ROUTE(app, "/api/reset").methods("POST"_method)
     ([&](){
+        std::lock_guard<std::mutex> lock(stateMutex);
         evaluator = Evaluator();
         sEvaluator = SymbolicEvaluator();
+        incrementalParser = IncrementalParser();
         return crow::response("Memory Cleared");
     });
 
     std::cout << "Math Engine running on port 8080..." << std::endl;
     app.port(8080).multithreaded().run();
 
+    if (!saveLibraryPath.empty() && !saveLibrary(saveLibraryPath, parser, sEvaluator)) {
+        std::cerr << "Could not write " << saveLibraryPath << std::endl;
+        return 1;
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,201 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "Lexer/inc/Lexer.hpp"
+#include "Parser/inc/Parser.hpp"
+#include "Serializer/inc/ASTSerializer.hpp"
+#include "Util/inc/ASTPrint.hpp"
+
+static std::vector<NodePtr> parse(const std::string &input, Parser &parser) {
+    Lexer lexer(input);
+    auto statements = parser.parse(lexer);
+    EXPECT_EQ(parser.getError(), "");
+    return statements;
+}
+
+static std::vector<ASTFormat::Entry> read(const std::string &data, std::string &error) {
+    ASTReader reader(data.data(), data.size());
+    auto entries = reader.read();
+    error = reader.getError();
+    return entries;
+}
+
+/* Header and symbol table of a hand written encoding with the single symbol "x" */
+static std::string headerWithX() {
+    std::string data(ASTFormat::magic, sizeof(ASTFormat::magic));
+    data += '\x01'; /* version */
+    data += '\x01'; /* symbol count */
+    data += '\x01';
+    data += 'x';
+    return data;
+}
+
+TEST(ASTSerializerTest, RoundTripKeepsEveryTree) {
+    Parser parser;
+    parser.setSimplify(false);
+    auto statements = parse("f(x, y) = -x^2 + sin(y)! / 0.1\n"
+                            "a = 3e8\n"
+                            "g(t) = d/dt(f(t, a) * atan2(t, pi))\n"
+                            "-a - 2.5\n", parser);
+    ASSERT_EQ(statements.size(), 4u);
+
+    ASTWriter writer;
+    for (const auto &statement: statements) {
+        std::vector<std::string> parameters;
+        if (statement->type == Node::Type::FunctionAssignment) parameters = parser.getFunctionParameters(statement->symbol);
+        writer.add(statement, parameters);
+    }
+
+    std::string error;
+    auto entries = read(writer.finish(), error);
+    ASSERT_EQ(error, "");
+    ASSERT_EQ(entries.size(), statements.size());
+    for (size_t i = 0; i < statements.size(); ++i) {
+        EXPECT_TRUE(Node::equal(entries[i].statement.get(), statements[i].get())) << toLisp(statements[i]);
+        EXPECT_EQ(toLisp(entries[i].statement), toLisp(statements[i]));
+    }
+    EXPECT_EQ(entries[0].parameters, (std::vector<std::string>{"x", "y"}));
+    EXPECT_EQ(entries[2].parameters, (std::vector<std::string>{"t"}));
+    EXPECT_TRUE(entries[1].parameters.empty());
+}
+
+TEST(ASTSerializerTest, EmptyWriterRoundTrips) {
+    std::string error;
+    auto entries = read(ASTWriter().finish(), error);
+    EXPECT_EQ(error, "");
+    EXPECT_TRUE(entries.empty());
+}
+
+TEST(ASTSerializerTest, RejectsTruncatedData) {
+    Parser parser;
+    auto statements = parse("f(x) = x^2 + 1.5 * cos(x)", parser);
+    ASTWriter writer;
+    writer.add(statements[0], parser.getFunctionParameters(statements[0]->symbol));
+    const std::string data = writer.finish();
+
+    for (size_t size = 0; size < data.size(); ++size) {
+        std::string error;
+        auto entries = read(data.substr(0, size), error);
+        EXPECT_NE(error, "") << "prefix of " << size << " bytes";
+        EXPECT_TRUE(entries.empty());
+    }
+}
+
+TEST(ASTSerializerTest, RejectsOutOfRangeSymbolIds) {
+    std::string node = headerWithX();
+    node += '\x01'; /* entry count */
+    node += '\x00'; /* parameter count */
+    node += static_cast<char>(Node::Type::Variable);
+    node += '\x05'; /* symbol id, only 0 exists */
+    node += '\x00'; /* child count */
+
+    std::string error;
+    EXPECT_TRUE(read(node, error).empty());
+    EXPECT_EQ(error, "Symbol id 5 is out of range.");
+
+    std::string parameter = headerWithX();
+    parameter += '\x01';
+    parameter += '\x01'; /* parameter count */
+    parameter += '\x01'; /* parameter symbol id */
+    EXPECT_TRUE(read(parameter, error).empty());
+    EXPECT_EQ(error, "Symbol id 1 is out of range.");
+}
+
+TEST(ASTSerializerTest, RejectsTrailingBytes) {
+    Parser parser;
+    auto statements = parse("2x + 1", parser);
+    ASTWriter writer;
+    writer.add(statements[0]);
+
+    std::string error;
+    EXPECT_TRUE(read(writer.finish() + '\0', error).empty());
+    EXPECT_EQ(error, "Trailing data after the last entry.");
+}
+
+TEST(ASTSerializerTest, RejectsForeignData) {
+    std::string error;
+    EXPECT_TRUE(read("M2AX\x01\x00\x00", error).empty());
+    EXPECT_EQ(error, "Not a serialized AST.");
+
+    std::string future(ASTFormat::magic, sizeof(ASTFormat::magic));
+    future += '\x02';
+    EXPECT_TRUE(read(future, error).empty());
+    EXPECT_EQ(error, "Unsupported AST format version 2.");
+}
+
+/* One entry holding a node named x with the given children, each child a variable x */
+static std::string entryWithChildren(Node::Type type, size_t childCount, size_t parameterCount = 1) {
+    std::string data = headerWithX();
+    data += '\x01'; /* entry count */
+    data += static_cast<char>(parameterCount);
+    for (size_t i = 0; i < parameterCount; ++i) data += '\x00';
+    data += static_cast<char>(type);
+    data += '\x00'; /* symbol id of x */
+    data += static_cast<char>(childCount);
+    for (size_t i = 0; i < childCount; ++i) {
+        data += static_cast<char>(Node::Type::Variable);
+        data += '\x00';
+        data += '\x00';
+    }
+    return data;
+}
+
+TEST(ASTSerializerTest, RejectsChildCountsTheParserCannotProduce) {
+    std::string error;
+    EXPECT_TRUE(read(entryWithChildren(Node::Type::Variable, 1), error).empty());
+    EXPECT_EQ(error, "1 children are not valid for 'x'.");
+    EXPECT_TRUE(read(entryWithChildren(Node::Type::Assignment, 2), error).empty());
+    EXPECT_EQ(error, "2 children are not valid for 'x'.");
+    EXPECT_TRUE(read(entryWithChildren(Node::Type::FunctionAssignment, 0), error).empty());
+    EXPECT_EQ(error, "0 children are not valid for 'x'.");
+    EXPECT_TRUE(read(entryWithChildren(Node::Type::Function, 0), error).empty());
+    EXPECT_EQ(error, "0 children are not valid for 'x'.");
+    EXPECT_TRUE(read(entryWithChildren(Node::Type::Operand, 2), error).empty());
+    EXPECT_EQ(error, "Unknown operator 'x'.");
+
+    /* Built-in operators and functions, from parsed trees with one child added or removed. A minus is left out,
+       with one child it is read as a negation and with two as a subtraction. */
+    Parser parser;
+    parser.setSimplify(false);
+    for (const char *input: {"x * x", "x / x", "x ^ x", "x!", "sin(x)", "atan2(x, x)", "d/dx(x)"}) {
+        auto statements = parse(input, parser);
+        ASSERT_EQ(statements.size(), 1u);
+        for (bool add: {true, false}) {
+            const Node::Children &children = statements[0]->children;
+            Node::Children changed;
+            for (size_t i = 0; i + 1 < children.size(); ++i) changed.push_back(children[i]);
+            if (add) {
+                changed.push_back(children.back());
+                changed.push_back(makeNode(Node::Type::Variable, "x"));
+            }
+            NodePtr node = statements[0]->withChildren(std::move(changed));
+            ASTWriter writer;
+            writer.add(node);
+            EXPECT_TRUE(read(writer.finish(), error).empty()) << input << (add ? " with an extra child" : " without a child");
+            EXPECT_NE(error, "");
+        }
+    }
+}
+
+TEST(ASTSerializerTest, RejectsMalformedFunctionDefinitions) {
+    std::string error;
+    EXPECT_TRUE(read(entryWithChildren(Node::Type::FunctionAssignment, 1, 0), error).empty());
+    EXPECT_EQ(error, "Function 'x' has no parameters.");
+
+    std::string nullBody = headerWithX();
+    nullBody += '\x01'; /* entry count */
+    nullBody += '\x01'; /* parameter count */
+    nullBody += '\x00';
+    nullBody += static_cast<char>(Node::Type::FunctionAssignment);
+    nullBody += '\x00';
+    nullBody += '\x01'; /* child count */
+    nullBody += static_cast<char>(ASTFormat::nullTag);
+    EXPECT_TRUE(read(nullBody, error).empty());
+    EXPECT_EQ(error, "Missing child of 'x'.");
+
+    EXPECT_EQ(read(entryWithChildren(Node::Type::FunctionAssignment, 1), error).size(), 1u);
+    EXPECT_EQ(error, "");
+}
@@ -0,0 +1,172 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "Evaluator/inc/Bytecode.hpp"
+#include "Evaluator/inc/Evaluator.hpp"
+#include "Evaluator/inc/Jit.hpp"
+#include "Lexer/inc/Lexer.hpp"
+#include "Parser/inc/Parser.hpp"
+#include "Util/inc/ASTPrint.hpp"
+
+static const char *library =
+    "f(t) = t^2 + 1\n"
+    "g(a, b) = atan2(a, b) * f(b)\n"
+    "h(u) = g(u, u / 2) - u!\n";
+
+/* Every statement is structurally different from the others, so an Evaluator sees each one first with the tree walk */
+static const char *corpus =
+    "x / y\n"
+    "1 / 0\n"
+    "x / (y - y)\n"
+    "0 / 0\n"
+    "f(1 / x) + y\n"
+    "sqrt(-1)\n"
+    "ln(x) * y\n"
+    "x - x\n"
+    "0 * x + y\n"
+    "x ^ y\n"
+    "y ^ 0.5\n"
+    "(-8) ^ (1 / 3)\n"
+    "atan2(x, y)\n"
+    "atan2(y, x) ^ x\n"
+    "atan2(0, -0)\n"
+    "x!\n"
+    "(x + 0.5)!\n"
+    "(-x)!\n"
+    "171!\n"
+    "f(x)\n"
+    "g(x, y)\n"
+    "h(x) + f(y)\n"
+    "g(f(x), h(y))\n"
+    "-x * 0\n"
+    "sin(x) + cos(y) - tan(x y)\n"
+    "log(abs(x)) + abs(y)\n"
+    "e^x - pi y\n"
+    "x + w\n"
+    "f(w) / 0\n";
+
+/* Values of x and y, which include the ones that turn operations into inf and NaN */
+static const double values[] = {0.0, -0.0, 1.0, -2.5, 3.0, 0.5, 170.0, 1e308, -1e-310,
+                                std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                                std::numeric_limits<double>::quiet_NaN()};
+
+static std::vector<NodePtr> parse(Parser &parser, const std::string &input) {
+    Lexer lexer(input);
+    auto statements = parser.parse(lexer, false, 1);
+    EXPECT_EQ(parser.getError(), "");
+    return statements;
+}
+
+static NodePtr assign(const char *name, double value) {
+    auto assignment = makeNode(Node::Type::Assignment, name);
+    assignment->children.push_back(Node::createNode(value));
+    return assignment;
+}
+
+/* Bit for bit, except that any NaN matches any other: when both operands are NaN, IEEE 754 leaves open which one comes
+   out, and the compiler may swap the operands of the tree walk's additions and multiplications */
+static bool sameBits(double a, double b) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+class BytecodeTest : public testing::Test {
+protected:
+    void SetUp() override {
+        Parser parser;
+        parser.setSimplify(false); /* Keeps every operation for the backends to compute */
+        definitions = parse(parser, library);
+        statements = parse(parser, corpus);
+        for (const auto &definition: definitions) functions[definition->symbol] = definition;
+    }
+
+    /* A new Evaluator with the library and the values, whose first evaluation of a statement is always the tree walk */
+    [[nodiscard]] Evaluator evaluatorFor(double x, double y) const {
+        Evaluator evaluator;
+        for (const auto &definition: definitions) evaluator.evaluate(definition);
+        evaluator.evaluate(assign("x", x));
+        evaluator.evaluate(assign("y", y));
+        return evaluator;
+    }
+
+    std::vector<NodePtr> definitions;
+    std::vector<NodePtr> statements;
+    SymbolMap<ConstNodePtr> functions;
+};
+
+TEST_F(BytecodeTest, BackendsMatchTheTreeWalkBitForBit) {
+    const SymbolId x = SymbolTable::intern("x"), y = SymbolTable::intern("y");
+    size_t failures = 0, undefined = 0;
+
+    for (const auto &statement: statements) {
+        const auto program = Bytecode::compile(statement.get(), functions);
+        ASSERT_TRUE(program) << toLisp(statement);
+        const auto native = JitFunction::compile(*program);
+#if defined(__x86_64__)
+        ASSERT_TRUE(native) << toLisp(statement);
+#endif
+        std::vector<double> scratch(program->getScratchSize());
+
+        for (double xValue: values) {
+            for (double yValue: values) {
+                Evaluator evaluator = evaluatorFor(xValue, yValue);
+                const double expected = evaluator.evaluate(statement);
+                const bool failed = !evaluator.getError().empty();
+                const std::string where = toLisp(statement) + " at x = " + std::to_string(xValue) + ", y = " + std::to_string(yValue);
+
+                std::vector<double> slotValues;
+                for (SymbolId slot: program->getSlots()) {
+                    if (slot == x) slotValues.push_back(xValue);
+                    else if (slot == y) slotValues.push_back(yValue);
+                }
+                if (slotValues.size() < program->getSlots().size()) {
+                    /* A slot without a value is a variable the tree walk cannot find either */
+                    EXPECT_TRUE(failed) << where;
+                    undefined++;
+                    continue;
+                }
+
+                failures += failed;
+                double result;
+                const bool ran = program->run(slotValues.data(), scratch.data(), result);
+                EXPECT_EQ(ran, !failed) << where << ": " << evaluator.getError();
+                if (ran && !failed) {
+                    EXPECT_TRUE(sameBits(result, expected)) << where << ": " << result << " != " << expected;
+                }
+                if (!native) continue;
+
+                const double nativeResult = (*native)(slotValues.data());
+                if (failed) {
+                    EXPECT_TRUE(std::isnan(nativeResult)) << where;
+                } else {
+                    EXPECT_TRUE(sameBits(nativeResult, expected)) << where << ": " << nativeResult << " != " << expected;
+                }
+            }
+        }
+    }
+    /* The corpus reaches both kinds of errors */
+    EXPECT_GT(failures, 0u);
+    EXPECT_GT(undefined, 0u);
+}
+
+/* The same corpus through the Evaluator's own verification, which runs both backends next to every tree walk */
+TEST_F(BytecodeTest, EvaluatorFindsNoCompiledMismatch) {
+    for (double xValue: values) {
+        for (double yValue: values) {
+            Evaluator evaluator = evaluatorFor(xValue, yValue);
+            evaluator.setVerifyCompiled(true);
+            for (const auto &statement: statements) evaluator.evaluate(statement);
+            for (const auto &mismatch: evaluator.getCompiledMismatches()) {
+                ADD_FAILURE() << mismatch.backend << " " << toLisp(mismatch.statement) << " at x = " << xValue << ", y = " << yValue
+                              << ": " << mismatch.actual << " != " << mismatch.expected;
+            }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "Evaluator/inc/Evaluator.hpp"
+#include "Lexer/inc/Lexer.hpp"
+#include "Parser/inc/Parser.hpp"
+#include "Serializer/inc/ASTSerializer.hpp"
+#include "Simplifier/inc/Simplifier.hpp"
+#include "Util/inc/ASTPrint.hpp"
+
+static std::string plotBatch(size_t points, const std::string &expression) {
+    std::string batch;
+    for (size_t i = 0; i < points; ++i) batch += "x = " + std::to_string(i * 0.01) + "\n" + expression + "\n";
+    return batch;
+}
+
+static std::vector<NodePtr> parse(Parser &parser, const std::string &input, unsigned threadCount) {
+    Lexer lexer(input);
+    auto statements = parser.parse(lexer, false, threadCount);
+    EXPECT_EQ(parser.getError(), "");
+    return statements;
+}
+
+class EvaluatorBatchTest : public testing::TestWithParam<unsigned> {};
+
+TEST_P(EvaluatorBatchTest, PlotBatchReachesTheCompiledPath) {
+    constexpr size_t points = 2000;
+    Parser parser;
+    auto statements = parse(parser, plotBatch(points, "sin(x)^2 + 3x"), GetParam());
+    ASSERT_EQ(statements.size(), 2 * points);
+
+    Evaluator evaluator;
+    for (size_t i = 0; i < points; ++i) {
+        evaluator.evaluate(statements[2 * i]);
+        const double x = static_cast<double>(i) * 0.01;
+        EXPECT_NEAR(evaluator.evaluate(statements[2 * i + 1]), std::sin(x) * std::sin(x) + 3 * x, 1e-9);
+    }
+    /* Every point after the first runs compiled; the assignments differ and stay with the tree walk */
+    EXPECT_EQ(evaluator.getCompiledEvaluations(), points - 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, EvaluatorBatchTest, testing::Values(1u, 4u));
+
+TEST(EvaluatorTest, EqualTreesShareOneProgram) {
+    Parser parser;
+    auto statements = parse(parser, "x = 2\nx^2 - ln(x) / 4", 1);
+    ASSERT_EQ(statements.size(), 2u);
+
+    Evaluator evaluator;
+    evaluator.evaluate(statements[0]);
+    const double expected = 4 - std::log(2.0) / 4;
+    for (int i = 0; i < 300; ++i) {
+        /* A new tree every time, as when the statement is parsed again without the cache */
+        EXPECT_DOUBLE_EQ(evaluator.evaluate(statements[1]->clone()), expected);
+    }
+    EXPECT_EQ(evaluator.getCompiledEvaluations(), 299u);
+
+    /* Another value of x runs through the same program */
+    auto changed = parse(parser, "x = 3\nx^2 - ln(x) / 4", 1);
+    evaluator.evaluate(changed[0]);
+    EXPECT_DOUBLE_EQ(evaluator.evaluate(changed[1]->clone()), 9 - std::log(3.0) / 4);
+    EXPECT_EQ(evaluator.getCompiledEvaluations(), 300u);
+}
+
+/* A negation and a subtraction share the name "-", only the opcode tells them apart */
+TEST(EvaluatorTest, NegationAndSubtractionDispatchOnTheirOpcode) {
+    Parser parser;
+    parser.setSimplify(false);
+    auto statements = parse(parser, "x = 5\n-x\n3 - x\n-(2 - x) - -x\n2 - -3", 1);
+    ASSERT_EQ(statements.size(), 5u);
+    EXPECT_EQ(statements[1]->op, Node::Op::Neg);
+    EXPECT_EQ(statements[2]->op, Node::Op::Sub);
+    EXPECT_EQ(statements[3]->op, Node::Op::Sub);
+    EXPECT_EQ(statements[3]->children[0]->op, Node::Op::Neg);
+    EXPECT_EQ(statements[3]->children[1]->op, Node::Op::Neg);
+
+    /* Written and read back, the reader has to recover Neg from the child count */
+    ASTWriter writer;
+    for (const auto &statement: statements) writer.add(statement);
+    const std::string data = writer.finish();
+    ASTReader reader(data.data(), data.size());
+    auto entries = reader.read();
+    ASSERT_EQ(reader.getError(), "");
+    ASSERT_EQ(entries.size(), statements.size());
+
+    const double expected[] = {5, -5, -2, 8, 5};
+    Evaluator evaluator, roundTripEvaluator;
+    for (size_t i = 0; i < statements.size(); ++i) {
+        const NodePtr &read = entries[i].statement;
+        EXPECT_TRUE(Node::equal(read.get(), statements[i].get())) << toLisp(statements[i]);
+        EXPECT_DOUBLE_EQ(evaluator.evaluate(statements[i]), expected[i]);
+        EXPECT_DOUBLE_EQ(roundTripEvaluator.evaluate(read), expected[i]);
+        EXPECT_EQ(toHumanReadable(read), toHumanReadable(statements[i]));
+        EXPECT_EQ(toLisp(Simplifier::simplify(read)), toLisp(Simplifier::simplify(statements[i])));
+    }
+}
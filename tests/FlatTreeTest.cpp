@@ -0,0 +1,106 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+
+#include "Evaluator/inc/Evaluator.hpp"
+#include "Lexer/inc/Lexer.hpp"
+#include "Node/inc/FlatTree.hpp"
+#include "Parser/inc/Parser.hpp"
+#include "Util/inc/ASTPrint.hpp"
+
+static const char *script =
+    "f(x, y) = x^2 - y / 4 + sin(x y)\n"
+    "a = 1.5\n"
+    "b = -a * 3! + atan2(a, 2)\n"
+    "f(a, b) + abs(-b) ^ 0.5\n"
+    "g(t) = f(t, t) * ln(t) + e\n"
+    "g(a + 1) - pi\n"
+    "sqrt(log(100)) / (a - 1.5)\n"
+    "c + 1\n"
+    "b = g(b)\n"
+    "b\n";
+
+static std::vector<NodePtr> parseScript(bool simplify) {
+    Parser parser;
+    parser.setSimplify(simplify);
+    Lexer lexer(script);
+    auto statements = parser.parse(lexer, true);
+    EXPECT_EQ(parser.getError(), "");
+    return statements;
+}
+
+class FlatTreeTest : public testing::TestWithParam<bool> {};
+
+TEST_P(FlatTreeTest, RoundTripsEveryStatement) {
+    for (const auto &statement: parseScript(GetParam())) {
+        const FlatTree tree = FlatTree::fromNode(statement);
+        EXPECT_TRUE(Node::equal(tree.toNode().get(), statement.get())) << toLisp(statement);
+        EXPECT_EQ(toLisp(tree), toLisp(statement));
+        EXPECT_EQ(toHumanReadable(tree), toHumanReadable(statement));
+    }
+}
+
+TEST_P(FlatTreeTest, EvaluatesLikeTheNodeTree) {
+    Evaluator nodeEvaluator, flatEvaluator;
+    for (const auto &statement: parseScript(GetParam())) {
+        const double expected = nodeEvaluator.evaluate(statement);
+        const double actual = flatEvaluator.evaluate(FlatTree::fromNode(statement));
+        EXPECT_EQ(flatEvaluator.getError(), nodeEvaluator.getError()) << toLisp(statement);
+        if (std::isnan(expected)) {
+            EXPECT_TRUE(std::isnan(actual)) << toLisp(statement);
+        } else {
+            EXPECT_EQ(std::memcmp(&expected, &actual, sizeof(double)), 0) << toLisp(statement) << ": " << actual << " != " << expected;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Simplify, FlatTreeTest, testing::Bool());
+
+TEST(FlatTreeTest, EmptyTreeIsAnError) {
+    Evaluator evaluator;
+    EXPECT_TRUE(std::isnan(evaluator.evaluate(FlatTree::fromNode(nullptr))));
+    EXPECT_NE(evaluator.getError(), "");
+    EXPECT_EQ(FlatTree::fromNode(nullptr).toNode(), nullptr);
+}
+
+/* Statements with more than one error, where the tree walk's order decides which one is reported */
+TEST(FlatTreeTest, ReportsTheErrorTheTreeWalkReports) {
+    Parser parser;
+    parser.setSimplify(false);
+    Lexer lexer("f(t) = 1 / (t - t)\n"
+                "u / 0\n"
+                "u / v\n"
+                "(1 / 0) + u\n"
+                "u + 1 / 0\n"
+                "f(u)\n"
+                "f(2) * u\n"
+                "u * f(2)\n"
+                "atan2(u, 1 / 0)\n"
+                "f(u / 0)\n");
+    auto statements = parser.parse(lexer, true);
+    ASSERT_EQ(parser.getStatementErrors().size(), 0u);
+    ASSERT_EQ(statements.size(), 10u);
+
+    /* The parser checks arity and names, so these are built directly */
+    auto unknownFunction = makeNode(Node::Type::Function, "h");
+    unknownFunction->children.push_back(makeNode(Node::Type::Variable, "u"));
+    statements.push_back(unknownFunction);
+    auto unaryAtan2 = makeNode(Node::Type::Function, "atan2");
+    unaryAtan2->children.push_back(makeNode(Node::Type::Variable, "u"));
+    statements.push_back(unaryAtan2);
+
+    Evaluator nodeEvaluator, flatEvaluator;
+    for (const auto &statement: statements) {
+        nodeEvaluator.evaluate(statement);
+        flatEvaluator.evaluate(FlatTree::fromNode(statement));
+        EXPECT_EQ(flatEvaluator.getError(), nodeEvaluator.getError()) << toLisp(statement);
+        if (statement->type != Node::Type::FunctionAssignment) {
+            EXPECT_NE(nodeEvaluator.getError(), "") << toLisp(statement);
+        }
+    }
+}
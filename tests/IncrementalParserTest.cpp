@@ -0,0 +1,93 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "Lexer/inc/Lexer.hpp"
+#include "Parser/inc/IncrementalParser.hpp"
+#include "Util/inc/ASTPrint.hpp"
+
+/* Every run gets a new Parser, so a node can only come back unchanged through the IncrementalParser and not through
+   the parse cache */
+static std::vector<NodePtr> run(IncrementalParser &incrementalParser, const std::string &cell) {
+    Parser parser;
+    return incrementalParser.parse(0, cell, parser);
+}
+
+/* Error of parsing the whole cell at once, empty if it parses */
+static std::string fullRunError(const std::string &cell) {
+    Parser parser;
+    Lexer lexer(cell);
+    if (!lexer.getError().empty()) return lexer.getError();
+    parser.parse(lexer);
+    return parser.getError();
+}
+
+TEST(IncrementalParserTest, ReusesStatementsBeforeAndAfterTheEdit) {
+    IncrementalParser incrementalParser;
+    auto before = run(incrementalParser, "a = 1\nb = (2 +\n 3)\nc = a + b\nd = 4");
+    ASSERT_EQ(before.size(), 4u);
+
+    auto after = run(incrementalParser, "a = 1\nb = 7\nc = a + b\nd = 4");
+    ASSERT_EQ(after.size(), 4u);
+    EXPECT_EQ(after[0].get(), before[0].get());
+    EXPECT_NE(after[1].get(), before[1].get());
+    EXPECT_EQ(toLisp(after[1]), "(= b 7)");
+    EXPECT_EQ(after[2].get(), before[2].get());
+    EXPECT_EQ(after[3].get(), before[3].get());
+}
+
+TEST(IncrementalParserTest, ReparsesStatementsWhoseWordsResolveDifferently) {
+    IncrementalParser incrementalParser;
+    auto before = run(incrementalParser, "f(t) = t^2\ny = f(3)");
+    ASSERT_EQ(before.size(), 2u);
+
+    /* f turns from a function into a variable, so f(3) becomes a product */
+    auto after = run(incrementalParser, "f = 2\ny = f(3)");
+    ASSERT_EQ(after.size(), 2u);
+    EXPECT_NE(after[1].get(), before[1].get());
+    EXPECT_NE(toLisp(after[1]), toLisp(before[1]));
+
+    Parser parser;
+    Lexer lexer("f = 2\ny = f(3)");
+    EXPECT_EQ(toLisp(after[1]), toLisp(parser.parse(lexer)[1]));
+}
+
+TEST(IncrementalParserTest, ErrorsMatchAFullRun) {
+    const std::string cells[] = {
+        "a = 1\nb = a + 2\nc = b * 3",
+        "a = 1\nb = a +\nc = b * 3",
+        "a = 1\nb = a $ 2\nc = b * 3",
+        "a = 1\nb = (a + 2\nc = b * 3",
+        "a = 1\nb = a + 2\nc = b * 3\nf(t) = t + q",
+        "a = 1\nb = a + 2\nc = b * 3",
+    };
+    IncrementalParser incrementalParser;
+    for (const auto &cell: cells) {
+        auto statements = run(incrementalParser, cell);
+        EXPECT_EQ(incrementalParser.getError(), fullRunError(cell)) << cell;
+        EXPECT_EQ(statements.empty(), !fullRunError(cell).empty()) << cell;
+    }
+}
+
+TEST(IncrementalParserTest, KeepsTheSuffixAfterAParseError) {
+    IncrementalParser incrementalParser;
+    auto before = run(incrementalParser, "a = 1\nb = 2\nc = a + b\nd = 4");
+    ASSERT_EQ(before.size(), 4u);
+
+    EXPECT_TRUE(run(incrementalParser, "a = 1\nb = 2 +\nc = a + b\nd = 4").empty());
+    EXPECT_NE(incrementalParser.getError(), "");
+
+    auto fixed = run(incrementalParser, "a = 1\nb = 5\nc = a + b\nd = 4");
+    EXPECT_EQ(incrementalParser.getError(), "");
+    ASSERT_EQ(fixed.size(), 4u);
+    EXPECT_EQ(fixed[0].get(), before[0].get());
+    EXPECT_EQ(fixed[2].get(), before[2].get());
+    EXPECT_EQ(fixed[3].get(), before[3].get());
+
+    /* The failed statement itself is never taken for a parsed one */
+    EXPECT_TRUE(run(incrementalParser, "a = 1\nb = 2 +\nc = a + b\nd = 4").empty());
+    EXPECT_TRUE(run(incrementalParser, "a = 1\nb = 2 +\nc = a + b\nd = 5").empty());
+    EXPECT_EQ(incrementalParser.getError(), fullRunError("a = 1\nb = 2 +\nc = a + b\nd = 5"));
+}
@@ -0,0 +1,158 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <regex>
+#include <sstream>
+
+#include "Lexer/inc/Lexer.hpp"
+
+struct ScannedToken {
+    Token::Type type;
+    std::string value;
+    int line;
+    int pos;
+
+    bool operator==(const ScannedToken &) const = default;
+};
+
+static std::ostream &operator<<(std::ostream &os, const ScannedToken &token) {
+    return os << static_cast<int>(token.type) << " '" << token.value << "' L" << token.line << " P" << token.pos;
+}
+
+/* The regex table the scanner replaced, kept as the reference for its tokens and error text. A newline at the very
+   start of the input counts from offset 0; the old lexer searched back from npos there and got a garbage column. */
+static std::string regexLex(const std::string &input, std::vector<ScannedToken> &tokens) {
+    using Type = Token::Type;
+    static const std::vector<std::pair<Type, std::regex>> specification = {
+        {Type::Skip, std::regex(R"(#.*)")},
+        {Type::Number, std::regex(R"(\d+(\.\d*)?([eE][+-]?\d+)?)")},
+        {Type::Derivative, std::regex(R"((d/d((_\w*)|([a-zA-Z]_\w*)|([a-zA-Z]))))")},
+        {Type::Word, std::regex(R"((\b(pi|sin|cos|tan|log|ln|sqrt|abs|atan2)\b))")},
+        {Type::Word, std::regex(R"((_\w*)|([a-zA-Z]_\w*)|([a-zA-Z]))")},
+        {Type::Symbol, std::regex(R"([!=\+\-\*/\^\(\)])")},
+        {Type::Newline, std::regex(R"(\n)")},
+        {Type::Skip, std::regex(R"([ \t\r]+)")},
+        {Type::Comma, std::regex(R"(,)")},
+    };
+
+    size_t position = 0;
+    int line = 1;
+    while (position < input.length()) {
+        bool matched = false;
+        for (const auto &[type, re]: specification) {
+            std::smatch match;
+            if (!std::regex_search(input.cbegin() + static_cast<long>(position), input.cend(), match, re,
+                                   std::regex_constants::match_continuous)) continue;
+            size_t lineStart = position == 0 ? std::string::npos : input.rfind('\n', position - 1);
+            lineStart = lineStart == std::string::npos ? 0 : lineStart + 1;
+            if (type != Type::Skip) tokens.push_back({type, match.str(), line, static_cast<int>(position - lineStart)});
+            if (type == Type::Newline) line++;
+            position += match.length();
+            matched = true;
+            break;
+        }
+        if (!matched) {
+            size_t lineStart = input.rfind('\n', position);
+            lineStart = lineStart == std::string::npos ? 0 : lineStart + 1;
+            const size_t lineEnd = input.find('\n', position);
+            std::ostringstream error;
+            error << "Unexpected character \"" << input[position] << "\" at line " << line << ", column "
+                  << (position - lineStart) << ".\n";
+            error << "    " << input.substr(lineStart, lineEnd - lineStart) << "\n";
+            error << "    " << std::string(position - lineStart, ' ') << "^-- This should not be here.";
+            tokens.clear();
+            return error.str();
+        }
+    }
+    return "";
+}
+
+static std::vector<ScannedToken> getTokens(const Lexer &lexer) {
+    std::vector<ScannedToken> tokens;
+    for (int i = 0; lexer.peek(i).type != Token::Type::Eof; ++i) {
+        const Token &token = lexer.peek(i);
+        tokens.push_back({token.type, std::string(token.value), token.line, token.pos});
+    }
+    return tokens;
+}
+
+static void expectSameAsRegexLexer(const std::string &input) {
+    std::vector<ScannedToken> expected;
+    const std::string expectedError = regexLex(input, expected);
+    Lexer lexer(input);
+    EXPECT_EQ(lexer.getError(), expectedError) << input;
+    EXPECT_EQ(getTokens(lexer), expected) << input;
+}
+
+TEST(LexerTest, ScannerMatchesRegexLexer) {
+    const char *inputs[] = {
+        "1 2.5 3. 4e10 5E-3 6e+2 7.25e 8e+ 9.e1 0012",
+        "d/dx(x^2) d/d_v(_v) d/dy_1(y_1) d/d d/d5 d/dxy",
+        "pi sin cos tan log ln sqrt abs atan2 2pi sinx xsin atan2_ sqrt(4) pi_",
+        "x y_1 _ _a1 __ a_b_c Z X_ xy xY_z",
+        "f(x, y) = -x! ^ 2 / (3 * y) + 4\n\ng(t)=t\r\n# comment with $ and ?\n  \t y # tail",
+        "1 + $",
+        "x = 1\ny = 2 @ 3",
+        "a\n\tb ~",
+        ".5",
+        "x # comment $ is fine\n&",
+    };
+    for (const char *input: inputs) expectSameAsRegexLexer(input);
+}
+
+TEST(LexerTest, ScannerMatchesRegexLexerOnRandomInput) {
+    static const std::vector<std::string> pieces = {
+        "0", "7", "12", ".", "e", "E", "+", "-", "*", "/", "^", "(", ")", "!", "=", ",", " ", "\t", "\r", "\n",
+        "#", "x", "y", "d", "_", "_1", "a_", "sin", "cos", "atan2", "pi", "ln", "log", "sqrt", "abs", "tan", "d/d",
+        "d/dx", "1e5", "2.5E-3", "$", "?", "&"
+    };
+    std::mt19937 random(17);
+    std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1), length(1, 24);
+    for (int i = 0; i < 3000; ++i) {
+        std::string input;
+        for (size_t n = length(random); n > 0; --n) input += pieces[piece(random)];
+        expectSameAsRegexLexer(input);
+    }
+}
+
+/* Enough lines to split into four chunks, each above the threshold below which the input is lexed on one thread */
+static std::string largeInput() {
+    std::string input;
+    for (int i = 0; input.size() < 1200 * 1024; ++i) {
+        input += "x_" + std::to_string(i) + " = 2.5e3 * sin(y) - d/dt(t^2) # note " + std::to_string(i) + "\n";
+        if (i % 7 == 0) input += "\n";
+    }
+    return input;
+}
+
+static void expectSameAsSerial(const std::string &input) {
+    const Lexer serial(input);
+    const Lexer parallel = Lexer::createParallel(input, 4);
+    EXPECT_EQ(parallel.getError(), serial.getError());
+    EXPECT_EQ(getTokens(parallel), getTokens(serial));
+}
+
+TEST(LexerTest, ParallelLexingMatchesSerial) {
+    const std::string input = largeInput();
+    expectSameAsSerial(input);
+    EXPECT_EQ(Lexer::createParallel(input, 4).getError(), "");
+}
+
+TEST(LexerTest, ParallelLexingReportsAnErrorInALaterChunk) {
+    std::string input = largeInput();
+    input.insert(input.rfind("sin", input.size() - 100), 1, '$');
+    expectSameAsSerial(input);
+    EXPECT_NE(Lexer::createParallel(input, 4).getError(), "");
+}
+
+TEST(LexerTest, ParallelLexingReportsTheEarliestOfSeveralErrors) {
+    std::string input = largeInput();
+    input.insert(input.rfind("sin", input.size() - 100), 1, '&');
+    input.insert(input.find("sin", input.size() / 3), 1, '$');
+    expectSameAsSerial(input);
+    EXPECT_EQ(Lexer::createParallel(input, 4).getError().rfind("Unexpected character \"$\"", 0), 0u);
+}
@@ -0,0 +1,81 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "Evaluator/inc/Evaluator.hpp"
+#include "Lexer/inc/Lexer.hpp"
+#include "Node/inc/Node.hpp"
+#include "Parser/inc/Parser.hpp"
+
+/* Kept out of line, GCC 12 cannot tell the count stays above zero and warns of a use after free otherwise */
+[[gnu::noinline]] static uint32_t references(const NodePtr &node) {
+    return node->references.count;
+}
+
+TEST(NodeTest, PointersCountTheirReferences) {
+    NodePtr node = makeNode(Node::Type::Variable, "x");
+    EXPECT_EQ(references(node), 1u);
+    {
+        NodePtr copy = node;
+        ConstNodePtr constant = copy;
+        EXPECT_EQ(references(node), 3u);
+        NodePtr moved = std::move(copy);
+        EXPECT_EQ(copy, nullptr);
+        EXPECT_EQ(references(node), 3u);
+        moved.reset();
+        EXPECT_EQ(references(node), 2u);
+    }
+    EXPECT_EQ(references(node), 1u);
+
+    NodePtr other = node;
+    other = makeNode(Node::Type::Variable, "y");
+    EXPECT_EQ(references(node), 1u);
+    other = node;
+    other = other;
+    EXPECT_EQ(references(node), 2u);
+    other.reset();
+    EXPECT_EQ(references(node), 1u);
+}
+
+/* A deleted parent releases its children, whether they are kept inline or spilled to the heap */
+TEST(NodeTest, DeletedParentReleasesItsChildren) {
+    NodePtr child = makeNode(Node::Type::Variable, "x");
+    for (size_t childCount: {1u, 2u, 5u}) {
+        NodePtr parent = makeNode(Node::Type::Function, "f");
+        for (size_t i = 0; i < childCount; ++i) parent->children.push_back(child);
+        EXPECT_EQ(references(child), childCount + 1);
+
+        NodePtr copy = parent->withChildren(parent->children);
+        EXPECT_EQ(references(child), 2 * childCount + 1);
+        copy.reset();
+        parent.reset();
+        EXPECT_EQ(references(child), 1u);
+    }
+
+    /* Through a chain, the grandparent's deletion reaches the leaf */
+    NodePtr grandparent = makeNode(Node::Type::Operand, "-");
+    grandparent->children.push_back(makeNode(Node::Type::Operand, "-"));
+    grandparent->children[0]->children.push_back(child);
+    EXPECT_EQ(references(child), 2u);
+    grandparent = nullptr;
+    EXPECT_EQ(references(child), 1u);
+}
+
+TEST(NodeTest, EvaluatorReleasesTheFunctionsItKeeps) {
+    Parser parser;
+    Lexer lexer("f(t) = t^2 + 1\nf(3)");
+    auto statements = parser.parse(lexer, false, 1);
+    ASSERT_EQ(statements.size(), 2u);
+    const NodePtr definition = statements[0];
+    statements.clear();
+    parser = Parser(); /* Drops the parse cache */
+    EXPECT_EQ(references(definition), 1u);
+    {
+        Evaluator evaluator;
+        evaluator.evaluate(definition);
+        EXPECT_GT(references(definition), 1u);
+    }
+    EXPECT_EQ(references(definition), 1u);
+}
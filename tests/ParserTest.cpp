@@ -0,0 +1,240 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <unordered_set>
+
+#include "Lexer/inc/Lexer.hpp"
+#include "Parser/inc/Parser.hpp"
+#include "Util/inc/ASTPrint.hpp"
+
+/* A plot batch as index.html sends it, large enough for the parallel path */
+static std::string plotBatch(size_t points, const std::string &expression) {
+    std::string batch;
+    for (size_t i = 0; i < points; ++i) batch += "x = " + std::to_string(i * 0.01) + "\n" + expression + "\n";
+    return batch;
+}
+
+static std::vector<NodePtr> parse(Parser &parser, const std::string &input, unsigned threadCount, bool recover = false) {
+    Lexer lexer(input);
+    auto statements = parser.parse(lexer, recover, threadCount);
+    EXPECT_EQ(parser.getError(), "");
+    return statements;
+}
+
+class ParserPathTest : public testing::TestWithParam<bool> {};
+
+TEST_P(ParserPathTest, RepeatedStatementsShareOneNodeOnEveryPath) {
+    const std::string batch = plotBatch(2000, "sin(x)^2 + 3x");
+    Parser sequential, parallel;
+    sequential.setSimplify(GetParam());
+    parallel.setSimplify(GetParam());
+    auto expected = parse(sequential, batch, 1);
+    auto statements = parse(parallel, batch, 4);
+
+    ASSERT_EQ(statements.size(), expected.size());
+    std::unordered_set<const Node *> expressions;
+    for (size_t i = 0; i < statements.size(); ++i) {
+        EXPECT_EQ(toLisp(statements[i]), toLisp(expected[i]));
+        if (i % 2) expressions.insert(statements[i].get());
+    }
+    EXPECT_EQ(expressions.size(), 1u);
+
+    /* The parallel path fills the cache the sequential path reads, and the other way round */
+    auto again = parse(parallel, "sin(x)^2 + 3x", 1);
+    ASSERT_EQ(again.size(), 1u);
+    EXPECT_EQ(again[0].get(), statements[1].get());
+    auto repeated = parse(sequential, batch, 4);
+    ASSERT_EQ(repeated.size(), expected.size());
+    EXPECT_EQ(repeated[1].get(), expected[1].get());
+}
+
+INSTANTIATE_TEST_SUITE_P(Simplify, ParserPathTest, testing::Bool());
+
+TEST(ParserTest, ParallelRepeatsFollowDefinitions) {
+    /* The same text means something else once y is defined, so it may not reuse the node parsed before */
+    std::string batch = plotBatch(1000, "2x") + "y = 2\n" + plotBatch(1000, "x y");
+    Parser sequential, parallel;
+    auto expected = parse(sequential, batch, 1);
+    auto statements = parse(parallel, batch, 4);
+    ASSERT_EQ(statements.size(), expected.size());
+    for (size_t i = 0; i < statements.size(); ++i) EXPECT_EQ(toLisp(statements[i]), toLisp(expected[i]));
+}
+
+TEST(ParserTest, ParallelRepeatsOfAFailingStatementAreAllReported) {
+    std::string batch = plotBatch(2000, "x +* 1");
+    Parser sequential, parallel;
+    auto expected = parse(sequential, batch, 1, true);
+    auto statements = parse(parallel, batch, 4, true);
+    EXPECT_EQ(statements.size(), expected.size());
+    EXPECT_EQ(parallel.getStatementErrors().size(), 2000u);
+    EXPECT_EQ(parallel.getStatementErrors().size(), sequential.getStatementErrors().size());
+}
+
+TEST(ParserTest, ParallelRepeatsOfAFailingStatementRecoverOnceDefined) {
+    /* Every repeat fails with the error of its own line until y is defined, and parses after that */
+    std::string batch = plotBatch(1000, "z = x + y") + "y = 2\n" + plotBatch(1000, "z = x + y");
+    Parser sequential, parallel;
+    auto expected = parse(sequential, batch, 1, true);
+    auto statements = parse(parallel, batch, 4, true);
+    ASSERT_EQ(statements.size(), expected.size());
+    for (size_t i = 0; i < statements.size(); ++i) EXPECT_EQ(toLisp(statements[i]), toLisp(expected[i]));
+
+    const auto &errors = parallel.getStatementErrors();
+    const auto &expectedErrors = sequential.getStatementErrors();
+    ASSERT_EQ(errors.size(), 1000u);
+    ASSERT_EQ(errors.size(), expectedErrors.size());
+    for (size_t i = 0; i < errors.size(); ++i) {
+        EXPECT_EQ(errors[i].statementIndex, expectedErrors[i].statementIndex);
+        EXPECT_EQ(errors[i].message, expectedErrors[i].message);
+    }
+}
+
+TEST(ParserTest, ParallelFailureReturnsWhatTheSequentialParseDoes) {
+    /* Nothing after the failing statement may be parsed, not even the unclosed tail the parallel path leaves behind */
+    const std::string batch = plotBatch(1000, "2x") + "x +* 1\n" + plotBatch(1000, "2x") + "z = (1\n";
+    Parser sequential, parallel;
+    Lexer sequentialLexer(batch), parallelLexer(batch);
+    auto expected = sequential.parse(sequentialLexer, false, 1);
+    auto statements = parallel.parse(parallelLexer, false, 4);
+    EXPECT_TRUE(expected.empty());
+    EXPECT_TRUE(statements.empty());
+    EXPECT_NE(sequential.getError(), "");
+    EXPECT_EQ(parallel.getError(), sequential.getError());
+}
+
+static size_t getDepth(const NodePtr &root) {
+    size_t depth = 0;
+    std::vector<std::pair<const Node *, size_t>> pending{{root.get(), 1}};
+    while (!pending.empty()) {
+        auto [node, level] = pending.back();
+        pending.pop_back();
+        depth = std::max(depth, level);
+        for (const auto &child: node->children) pending.emplace_back(child.get(), level + 1);
+    }
+    return depth;
+}
+
+/* Far deeper than the recursive descent parser could go before it ran out of stack */
+TEST(ParserTest, DeepNestingDoesNotOverflowTheStack) {
+    constexpr size_t depth = 100000;
+    Parser parser;
+    parser.setSimplify(false);
+
+    auto parentheses = parse(parser, std::string(depth, '(') + "x" + std::string(depth, ')'), 1);
+    ASSERT_EQ(parentheses.size(), 1u);
+    EXPECT_EQ(toLisp(parentheses[0]), "x");
+
+    std::string powers;
+    for (size_t i = 0; i < depth; ++i) powers += "2^";
+    auto tower = parse(parser, powers + "x", 1);
+    ASSERT_EQ(tower.size(), 1u);
+    EXPECT_EQ(getDepth(tower[0]), depth + 1);
+
+    auto negations = parse(parser, std::string(depth, '-') + "x", 1);
+    ASSERT_EQ(negations.size(), 1u);
+    EXPECT_EQ(getDepth(negations[0]), depth + 1);
+
+    Lexer unclosed(std::string(depth, '(') + "x");
+    parser.parse(unclosed);
+    EXPECT_EQ(parser.getError().rfind("Missing closing ')' for parenthesis that started on line 1.", 0), 0u);
+}
+
+TEST(ParserTest, FrameStackBuildsTheTreesOfTheRecursiveParser) {
+    const std::pair<const char *, std::vector<std::string>> cases[] = {
+        {"-2^-3! + 4", {"(+ (- (^ 2 (- (! 3)))) 4)"}},
+        {"f(x, y) = x * y^2\nf(2, 3)", {"(f (* x (^ y 2)))", "(f 2 3)"}},
+        {"x = 2\n2x sin x", {"(= x 2)", "(* (* 2 x) (sin x))"}},
+        {"atan2(1, 2) + - - 3", {"(+ (atan2 1 2) (- (- 3)))"}},
+        {"a = 1\n(a + (a * (a - 1)))", {"(= a 1)", "(+ a (* a (- a 1)))"}},
+        {"2^3^2", {"(^ 2 (^ 3 2))"}},
+        {"sqrt 4 * 3!", {"(sqrt (* 4 (! 3)))"}},
+    };
+    for (const auto &[input, expected]: cases) {
+        Parser parser;
+        parser.setSimplify(false);
+        auto statements = parse(parser, input, 1);
+        std::vector<std::string> printed;
+        for (const auto &statement: statements) printed.push_back(toLisp(statement));
+        EXPECT_EQ(printed, expected) << input;
+    }
+}
+
+/* Error text of the recursive parser, which the frame stack has to reproduce */
+TEST(ParserTest, MalformedInputGivesTheRecursiveParsersErrors) {
+    const std::pair<const char *, const char *> cases[] = {
+        {"1 +", "Infix operator '+' is missing a right-hand side expression.\n--> at line 1:\n    1 +\n      ^-- An expression was expected to follow this operator"},
+        {"* 2", "Unexpected token '*'\n--> at line 1:\n    * 2\n    ^-- This should not be here"},
+        {"(1 + 2", "Missing closing ')' for parenthesis that started on line 1.\n--> at line 1:\n    (1 + 2\n    ^-- This parenthesis was never closed.\n\nInstead, the input ended before the parenthesis was closed."},
+        {"()", "An expression was expected inside parentheses, but none was found.\n--> at line 1:\n    ()\n    ^-- Expected an expression after this parenthesis"},
+        {"1 2 +", "Missing operator between '1' and '2'.\n--> at line 1:\n    1 2 +\n      ^-- An operator was expected here."},
+        {"sin", "Expected an argument for function 'sin' but reached the end of the input.\n--> at line 1:\n    sin\n    ^-- Here"},
+        {"atan2(1)", "Function call without sufficient arguments.\n--> at line 1:\n    atan2(1)\n    ^-- 'atan2' expects 2 arguments."},
+        {"atan2(1, 2, 3)", "Function call with too many arguments.\n--> at line 1:\n    atan2(1, 2, 3)\n    ^-- 'atan2' expects 2 arguments."},
+        {"atan2 1, 2", "Multi argument function called without parentheses.\n--> at line 1:\n    atan2 1, 2\n    ^-- 'atan2' expects 2 arguments. Cannot call without parentheses."},
+        {"f(x) = x + y", "Use of undefined variable 'y'.\n--> at line 1:\n    f(x) = x + y\n               ^-- This variable has not been defined"},
+        {"2 = x", "Invalid target for assignment.\n--> at line 1:\n    2 = x\n      ^-- Cannot assign to this expression."},
+        {"pi = 3", "Assigment to constant value 'pi'.\n--> at line 1:\n    pi = 3\n       ^-- Cannot assign to this variable."},
+        {"-", "Prefix operator '-' is missing an expression on its right-hand side.\n--> at line 1:\n    -\n    ^-- An expression was expected to follow this operator"},
+        {"1 + (2 * (3 - )", "Infix operator '-' is missing a right-hand side expression.\n--> at line 1:\n    1 + (2 * (3 - )\n                ^-- An expression was expected to follow this operator"},
+        {"a = 1\nb = 2 * (a\nc = 3", "Missing closing ')' for parenthesis that started on line 2.\n--> at line 2:\n    b = 2 * (a\n            ^-- This parenthesis was never closed.\n\nInstead, found '=' here:\n--> at line 3:\n    c = 3\n      ^-- Expected ')'"},
+        {"(1 + 2))", "Unexpected token ')'\n--> at line 1:\n    (1 + 2))\n           ^-- This should not be here"},
+        {"f(x, y) = x\nf(1)", "Function call without sufficient arguments.\n--> at line 2:\n    f(1)\n    ^-- 'f' expects 2 arguments."},
+    };
+    for (const auto &[input, expected]: cases) {
+        Parser parser;
+        Lexer lexer(input);
+        EXPECT_TRUE(parser.parse(lexer).empty()) << input;
+        EXPECT_EQ(parser.getError(), expected) << input;
+    }
+}
+
+static std::vector<std::string> print(const std::vector<NodePtr> &statements) {
+    std::vector<std::string> printed;
+    for (const auto &statement: statements) printed.push_back(toLisp(statement));
+    return printed;
+}
+
+TEST(ParserTest, RecoverSkipsABadStatementBetweenGoodOnes) {
+    Parser parser;
+    parser.setSimplify(false);
+    auto statements = parse(parser, "a = 1\nb = 2 +\nc = a * 3", 1, true);
+    EXPECT_EQ(print(statements), (std::vector<std::string>{"(= a 1)", "(= c (* a 3))"}));
+    ASSERT_EQ(parser.getStatementErrors().size(), 1u);
+    EXPECT_EQ(parser.getStatementErrors()[0].statementIndex, 1u);
+    EXPECT_EQ(parser.getStatementErrors()[0].message,
+              "Infix operator '+' is missing a right-hand side expression.\n--> at line 2:\n    b = 2 +\n"
+              "          ^-- An expression was expected to follow this operator");
+
+    /* Without recover the same input gives nothing but the error */
+    Parser strict;
+    Lexer lexer("a = 1\nb = 2 +\nc = a * 3");
+    EXPECT_TRUE(strict.parse(lexer, false, 1).empty());
+    EXPECT_EQ(strict.getError(), parser.getStatementErrors()[0].message);
+}
+
+TEST(ParserTest, RecoverCountsTheStatementsBeforeEachError) {
+    Parser parser;
+    parser.setSimplify(false);
+    auto statements = parse(parser, "* 1\na = 1\nb = 2\n(a + b))\nc = a\nd = 1 2\ng = 3\nh +", 1, true);
+    EXPECT_EQ(print(statements), (std::vector<std::string>{"(= a 1)", "(= b 2)", "(= c a)", "(= g 3)"}));
+    std::vector<size_t> indices;
+    for (const auto &statementError: parser.getStatementErrors()) indices.push_back(statementError.statementIndex);
+    EXPECT_EQ(indices, (std::vector<size_t>{0, 2, 3, 4}));
+
+    /* Errors are collected per parse */
+    parse(parser, "x = 1", 1, true);
+    EXPECT_TRUE(parser.getStatementErrors().empty());
+}
+
+TEST(ParserTest, RecoverDropsOnlyTheFirstLineOfAnUnclosedParenthesis) {
+    Parser parser;
+    parser.setSimplify(false);
+    auto statements = parse(parser, "a = 1\nb = (2 +\nc = 3\nd = (c\n+ 1)", 1, true);
+    EXPECT_EQ(print(statements), (std::vector<std::string>{"(= a 1)", "(= c 3)", "(= d (+ c 1))"}));
+    ASSERT_EQ(parser.getStatementErrors().size(), 1u);
+    EXPECT_EQ(parser.getStatementErrors()[0].statementIndex, 1u);
+    EXPECT_EQ(parser.getStatementErrors()[0].message.rfind("Missing closing ')' for parenthesis that started on line 2.", 0), 0u);
+}
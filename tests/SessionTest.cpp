@@ -0,0 +1,127 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+
+#include "Session/inc/Session.hpp"
+
+static std::string run(const std::string &input, bool simplify) {
+    Parser parser;
+    Evaluator evaluator;
+    SymbolicEvaluator sEvaluator;
+    parser.setSimplify(simplify);
+    std::stringstream out;
+    processInput(input, parser, evaluator, sEvaluator, out);
+    return out.str();
+}
+
+class RawOutputTest : public testing::TestWithParam<const char *> {};
+
+/* Raw mode only changes how numbers are reached, statements that stay symbolic print the same */
+TEST_P(RawOutputTest, MatchesSimplifiedOutput) {
+    const std::string simplified = run(GetParam(), true);
+    EXPECT_EQ(run(GetParam(), false), simplified);
+    EXPECT_EQ(simplified.find("Error"), std::string::npos) << simplified;
+}
+
+INSTANTIATE_TEST_SUITE_P(Symbolic, RawOutputTest, testing::Values(
+    "-d/dx(5) * z ^ x ^ z + -2.25",
+    "x + y",
+    "2x + 3x - y * y / y",
+    "(a + b) * (a + b) ^ 2",
+    "x = 2\nx y + 3x",
+    "d/dx(x^3 + sin(x) * z)",
+    "f(t) = t^2 + 2t + t\nf(u) - u",
+    "g(t, s) = d/dt(t^2 * s) + 0 * s\ng(q, 2)",
+    "h(t) = t * 1 + 0\nh(w) / 1"
+));
+
+TEST(SessionTest, RawNumericStatementsAreEvaluatedDirectly) {
+    EXPECT_EQ(run("x = 3\n2x^2 + 1", false), "x = 3 = 3\n19\n");
+    EXPECT_EQ(run("x = 3\n2x^2 + 1", true), "x = 3 = 3\n19\n");
+}
+
+static std::string runStream(const std::string &script) {
+    Parser parser;
+    Evaluator evaluator;
+    SymbolicEvaluator sEvaluator;
+    std::istringstream input(script);
+    std::ostringstream out;
+    processStream(input, parser, evaluator, sEvaluator, out);
+    return out.str();
+}
+
+TEST(SessionTest, StreamJoinsStatementsThatSpanSeveralLines) {
+    EXPECT_EQ(runStream("x = 2\n"
+                        "f(t) = (t +\n"
+                        "  1) * 2\n"
+                        "f(x)\n"
+                        "y = (x\n"
+                        "* 3) + f(\n"
+                        "1)\n"
+                        "y + 1\n"),
+              "x = 2 = 2\n"
+              "Defined: f = 2(1 + t)\n"
+              "6\n"
+              "y = 4 + 3x = 10\n"
+              "11\n");
+}
+
+TEST(SessionTest, StreamErrorsCarryTheLineOfTheScript) {
+    EXPECT_EQ(runStream("x = 1\ny = x + 1\n\nz = (y +\n  2) $ 1\nx + 100\n"),
+              "x = 1 = 1\n"
+              "y = 1 + x = 2\n"
+              "Error: Unexpected character \"$\" at line 5, column 5.\n"
+              "      2) $ 1\n"
+              "         ^-- This should not be here.\n");
+
+    EXPECT_EQ(runStream("a = 1\nb = 2 +\nc = 3\n"),
+              "a = 1 = 1\n"
+              "Error: Infix operator '+' is missing a right-hand side expression.\n"
+              "--> at line 2:\n"
+              "    b = 2 +\n"
+              "          ^-- An expression was expected to follow this operator\n");
+}
+
+TEST(SessionTest, StreamStopsAtTheFirstError) {
+    /* The unclosed '(' takes the following lines into its statement, so "w = 5" is never run on its own */
+    const std::string output = runStream("x = 1\n# comment\ny = (x +\n 2\nw = 5\nx + 1\n");
+    EXPECT_EQ(output.rfind("x = 1 = 1\nError: Missing closing ')' for parenthesis that started on line 3.\n", 0), 0u) << output;
+    EXPECT_EQ(output.find("w = 5 = 5"), std::string::npos);
+    EXPECT_EQ(output.find("\n2\n"), std::string::npos);
+
+    EXPECT_EQ(runStream("x = 1\n1 +\nx = 2\nx\n"),
+              "x = 1 = 1\n"
+              "Error: Infix operator '+' is missing a right-hand side expression.\n"
+              "--> at line 2:\n"
+              "    1 +\n"
+              "      ^-- An expression was expected to follow this operator\n");
+}
+
+TEST(SessionTest, LibraryKeepsFunctionsThatAreAlreadyDefined) {
+    const std::string path = testing::TempDir() + "SessionTest.library";
+    {
+        Parser parser;
+        Evaluator evaluator;
+        SymbolicEvaluator sEvaluator;
+        std::stringstream out;
+        processInput("f(x) = x + 1\ng(x) = 3x", parser, evaluator, sEvaluator, out);
+        ASSERT_TRUE(saveLibrary(path, parser, sEvaluator));
+    }
+
+    /* The parser and both evaluators have to agree on f, or the call parses with two arguments and runs x + 1 */
+    Parser parser;
+    Evaluator evaluator;
+    SymbolicEvaluator sEvaluator;
+    std::stringstream out;
+    processInput("f(x, y) = x * y", parser, evaluator, sEvaluator, out);
+    ASSERT_TRUE(loadLibrary(path, parser, evaluator, sEvaluator, out));
+    out.str("");
+    processInput("f(2, 3)\ng(2)", parser, evaluator, sEvaluator, out);
+    EXPECT_EQ(out.str(), "6\n6\n");
+    std::remove(path.c_str());
+}
@@ -0,0 +1,93 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+
+#include "Lexer/inc/Lexer.hpp"
+#include "Parser/inc/Parser.hpp"
+#include "Simplifier/inc/Simplifier.hpp"
+#include "Util/inc/ASTPrint.hpp"
+
+/* Every cached hash in the tree matches the one a fresh copy computes */
+static void expectHashesCurrent(const NodePtr &node) {
+    if (!node) return;
+    NodePtr fresh = node->clone();
+    fresh->apply([](Node *copy) { copy->hash = 0; });
+    EXPECT_EQ(node->getHash(), fresh->getHash()) << toLisp(node);
+    for (const auto &child: node->children) expectHashesCurrent(child);
+}
+
+TEST(SimplifierTest, LeavesHashedInputIntact) {
+    Parser parser;
+    parser.setSimplify(false);
+    Lexer lexer("(a * b) ^ (-1 + x) + 0 - (-2 + y)\n"
+                "f(t) = (-1 + t) * t + 0 - t\n"
+                "(x / y) ^ (-3 + x) * (x / y)\n");
+    auto statements = parser.parse(lexer);
+    ASSERT_EQ(parser.getError(), "");
+
+    for (const auto &statement: statements) {
+        const std::string before = toLisp(statement);
+        const uint64_t hash = statement->getHash();
+        auto simplified = Simplifier::simplify(statement);
+        EXPECT_EQ(toLisp(statement), before);
+        EXPECT_EQ(statement->getHash(), hash);
+        expectHashesCurrent(statement);
+        expectHashesCurrent(simplified);
+    }
+}
+
+TEST(SimplifierTest, SharedSubtreeIsNotRewritten) {
+    Parser parser;
+    parser.setSimplify(false);
+    Lexer lexer("-1 + x");
+    auto shared = parser.parse(lexer)[0];
+    EXPECT_NE(shared->getHash(), 0u);
+
+    /* The same subtree under two parents, as the Simplifier itself builds when it distributes an exponent */
+    auto product = makeNode(Node::Type::Operand, "*");
+    product->children.push_back(shared);
+    product->children.push_back(shared);
+
+    auto simplified = Simplifier::simplify(product);
+    EXPECT_EQ(toHumanReadable(shared), "-1 + x");
+    EXPECT_EQ(toHumanReadable(simplified), "(x - 1)^2");
+    expectHashesCurrent(shared);
+    expectHashesCurrent(simplified);
+}
+
+static std::string simplified(const std::string &input) {
+    Parser parser;
+    Lexer lexer(input);
+    auto statements = parser.parse(lexer);
+    EXPECT_EQ(parser.getError(), "");
+    return statements.empty() ? "" : toHumanReadable(statements.back());
+}
+
+TEST(SimplifierTest, SubtractedTermsKeepTheirCoefficient) {
+    EXPECT_EQ(simplified("a - 3b"), "a - 3b");
+    EXPECT_EQ(simplified("a - 3b + 2a"), "3a - 3b");
+    EXPECT_EQ(simplified("3b - a"), "-a + 3b");
+    EXPECT_EQ(simplified("x^2 - 2x - 3"), "(-3 + x^2) - 2x");
+    EXPECT_EQ(simplified("b - 2 - a"), "(-2 - a) + b");
+}
+
+TEST(SimplifierTest, NumbersPrintInTheShortestFormThatReadsBack) {
+    const std::pair<double, const char *> numbers[] = {
+        {0.1, "0.1"}, {1.0 / 3, "0.3333333333333333"}, {2.0, "2"}, {-0.5, "-0.5"}, {1e300, "1e+300"},
+        {5e-324, "5e-324"}, {M_PI, "3.141592653589793"}, {std::nextafter(1.0, 2.0), "1.0000000000000002"}};
+    for (const auto &[value, expected]: numbers) {
+        const std::string text = toLisp(Node::createNode(value));
+        EXPECT_EQ(text, expected);
+        const double read = std::strtod(text.c_str(), nullptr);
+        EXPECT_EQ(std::memcmp(&read, &value, sizeof(value)), 0) << text;
+    }
+
+    /* Terms are grouped by their printed form, which must not round constants together */
+    EXPECT_EQ(simplified("sin(0.1234561x) + sin(0.1234562x)"), "sin(0.1234561x) + sin(0.1234562x)");
+    EXPECT_EQ(simplified("sin(0.1234561x) + sin(0.1234561x)"), "2sin(0.1234561x)");
+}
@@ -0,0 +1,52 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "Evaluator/inc/Evaluator.hpp"
+#include "Lexer/inc/Lexer.hpp"
+#include "Parser/inc/Parser.hpp"
+#include "Session/inc/Session.hpp"
+#include "SymbolicEvaluator/inc/SymbolicEvaluator.hpp"
+
+/*
+ * The symbol table is process-wide and never gives names back, so the tests that fill it
+ * get an executable of their own and cannot starve the tests of other suites.
+ */
+
+/* Adds made up names until the table takes no more from input */
+static void fillSymbolTable() {
+    for (size_t i = 0; SymbolTable::tryIntern("filler" + std::to_string(i)); ++i) {}
+}
+
+TEST(SymbolTableTest, FullSymbolTableIsALexerError) {
+    SymbolId known = SymbolTable::intern("x_known");
+    fillSymbolTable();
+
+    Lexer lexer("x_known + 1\nx_known * x_unseen");
+    EXPECT_EQ(lexer.getError(), "Too many names, \"x_unseen\" at line 2, column 10 is not known yet.\n"
+                                "    x_known * x_unseen\n"
+                                "              ^-- Use a name from earlier input.");
+
+    Lexer knownOnly("x_known + 1");
+    EXPECT_EQ(knownOnly.getError(), "");
+    EXPECT_EQ(knownOnly.peek().symbol, known);
+}
+
+TEST(SymbolTableTest, FullSymbolTableKeepsTheSessionRunning) {
+    fillSymbolTable();
+
+    Parser parser;
+    Evaluator evaluator;
+    SymbolicEvaluator sEvaluator;
+    std::ostringstream out;
+    processInput("x_unseen = 2", parser, evaluator, sEvaluator, out);
+    EXPECT_NE(out.str().find("Too many names"), std::string::npos) << out.str();
+
+    out.str("");
+    processInput("2 * 3", parser, evaluator, sEvaluator, out);
+    EXPECT_EQ(out.str(), "6\n");
+}
@@ -0,0 +1,64 @@
+//
+// Created by Erhan Türker on 10/17/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "Lexer/inc/Lexer.hpp"
+#include "Parser/inc/Parser.hpp"
+#include "SymbolicEvaluator/inc/SymbolicEvaluator.hpp"
+#include "Util/inc/ASTPrint.hpp"
+
+static std::vector<NodePtr> parse(Parser &parser, const std::string &input) {
+    Lexer lexer(input);
+    auto statements = parser.parse(lexer);
+    EXPECT_EQ(parser.getError(), "");
+    return statements;
+}
+
+static bool contains(const NodePtr &tree, const Node *subtree) {
+    if (tree.get() == subtree) return true;
+    for (const auto &child: tree->children) {
+        if (child && contains(child, subtree)) return true;
+    }
+    return false;
+}
+
+TEST(SymbolicEvaluatorTest, UnchangedSubtreesAreShared) {
+    Parser parser;
+    SymbolicEvaluator sEvaluator;
+    auto statements = parse(parser, "f(t) = t^2 + 1\nsin(u v) * f(w) + d/dx(x^3)");
+    ASSERT_EQ(statements.size(), 2u);
+    sEvaluator.registerFunction(statements[0]);
+
+    const NodePtr &input = statements[1];
+    const NodePtr expanded = sEvaluator.expand(input);
+    EXPECT_EQ(toLisp(expanded), "(+ (* (+ 1 (^ w 2)) (sin (* u v))) (* 3 (^ x 2)))");
+
+    /* The sine takes part in no expansion, so the result holds the parsed node itself */
+    const NodePtr &product = input->children[1];
+    ASSERT_EQ(product->children[1]->op, Node::Op::Sin);
+    EXPECT_TRUE(contains(expanded, product->children[1].get()));
+
+    /* A derivative found in the cache is the cached tree, not a copy of it. The sum around it rebuilds its terms,
+       but keeps their variable parts. */
+    const NodePtr again = sEvaluator.expand(input);
+    EXPECT_TRUE(Node::equal(again.get(), expanded.get()));
+    const NodePtr &square = expanded->children[1]->children[1];
+    ASSERT_EQ(toLisp(square), "(^ x 2)");
+    EXPECT_TRUE(contains(again, square.get()));
+
+    auto derivative = parse(parser, "d/dx(x^3)");
+    ASSERT_EQ(derivative.size(), 1u);
+    const NodePtr first = sEvaluator.expand(derivative[0]);
+    EXPECT_EQ(sEvaluator.expand(derivative[0]), first);
+    EXPECT_EQ(sEvaluator.expand(derivative[0]->clone()), first);
+}
+
+TEST(SymbolicEvaluatorTest, ExpressionWithoutDefinitionsIsReturnedAsIs) {
+    Parser parser;
+    SymbolicEvaluator sEvaluator;
+    auto statements = parse(parser, "sin(u v)^2 + 3w");
+    ASSERT_EQ(statements.size(), 1u);
+    EXPECT_EQ(sEvaluator.expand(statements[0]), statements[0]);
+}